@@ -0,0 +1,196 @@
+#include "Benchmark.h"
+#include "AlignedAllocator.h"
+#include "VectorNumeric.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ *  Бенчмаркове на AlignedVector спрямо Vector със стандартния алокатор за числовите
+ *  операции от VectorNumeric.h, при които подравняването и големите страници имат
+ *  значение: обхождане (sum, dot), поелементно събиране, запълване и растеж с push_back.
+ *
+ *  Преди измерванията се проверява подравняването на data() за различни размери и
+ *  съвпадението на резултатите с Vector; при разминаване програмата спира с код 1.
+ *  Колко от голям буфер е покрит с прозрачни големи страници се отпечатва на stderr. Пример:
+ *
+ *      aligned_benchmarks --max-size=1000000000 --filter=sum
+ */
+
+template<typename T> const char* type_name();
+template<> const char* type_name<float>()           { return "float"; }
+template<> const char* type_name<double>()          { return "double"; }
+
+template<typename T>
+T make_value(size_t i)
+{
+    return static_cast<T>(static_cast<int>(static_cast<std::uint32_t>(i * 2654435761u) >> 29) - 3);
+}
+
+template<typename T, typename V>
+V make_vector(size_t n, size_t seed)
+{
+    V vec;
+    vec.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        vec.push_back(make_value<T>(i + seed));
+    }
+    return vec;
+}
+
+/**
+ *  Килобайтите от изображението, съдържащо p, които ядрото е покрило с прозрачни
+ *  големи страници (AnonHugePages в /proc/self/smaps); 0, ако няма такава информация.
+ */
+size_t huge_page_kb(const void* p)
+{
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool inside = false;
+    while (std::getline(smaps, line))
+    {
+        unsigned long long begin, end;
+        if (std::sscanf(line.c_str(), "%llx-%llx ", &begin, &end) == 2)
+        {
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+            inside = begin <= address && address < end;
+        }
+        else if (inside && line.compare(0, 14, "AnonHugePages:") == 0)
+        {
+            return std::stoul(line.substr(14));
+        }
+    }
+    return 0;
+}
+
+bool aligned(const void* p, size_t alignment)
+{
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+/**
+ *  Проверява подравняването на data() след растеж, resize и shrink_to_fit и сверява
+ *  числовите операции с тези на Vector за тип T.
+ */
+template<typename T>
+bool verify()
+{
+    bool ok = true;
+    for (size_t n : {1, 2, 15, 16, 17, 255, 4093, 100003, 1000003})
+    {
+        AlignedVector<T> a = make_vector<T, AlignedVector<T> >(n, 0);
+        AlignedVector<T> b = make_vector<T, AlignedVector<T> >(n, 7);
+        const Vector<T> plain_a = make_vector<T, Vector<T> >(n, 0);
+        const Vector<T> plain_b = make_vector<T, Vector<T> >(n, 7);
+
+        AlignedVector<T> added;
+        add(a, b, added);
+        Vector<T> plain_added;
+        add(plain_a, plain_b, plain_added);
+
+        bool same = sum(a) == sum(plain_a) && dot(a, b) == dot(plain_a, plain_b) && added.size() == plain_added.size();
+        for (int i = 0; same && i < added.size(); ++i)
+        {
+            same = added[i] == plain_added[i];
+        }
+
+        bool is_aligned = aligned(a.data(), 64) && aligned(added.data(), 64);
+        a.resize(static_cast<int>(n / 3));
+        a.shrink_to_fit();
+        is_aligned = is_aligned && aligned(a.data(), 64);
+
+        AlignedVector<T, 4096> paged(static_cast<int>(n), T(1));
+        is_aligned = is_aligned && aligned(paged.data(), 4096) && sum(paged) == static_cast<T>(n);
+
+        if (!same || !is_aligned)
+        {
+            std::cerr << "mismatch: type=" << type_name<T>() << " size=" << n
+                      << (is_aligned ? "" : " (misaligned)") << "\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+template<typename T, typename V>
+void run_container(const BenchmarkOptions& options, size_t n, const char* container, std::vector<Measurement>& results)
+{
+    const V a = make_vector<T, V>(n, 0);
+    const V b = make_vector<T, V>(n, 7);
+    auto none = []() { return 0; };
+
+    auto record = [&](const char* operation, Measurement m)
+    {
+        m.suite = "aligned";
+        m.container = container;
+        m.type = type_name<T>();
+        m.operation = operation;
+        m.size = n;
+        results.push_back(m);
+    };
+
+    if (options.selected("sum"))
+    {
+        record("sum", measure(none, [&](int&) { do_not_optimize(sum(a)); }, n, options.repetitions));
+    }
+    if (options.selected("dot"))
+    {
+        record("dot", measure(none, [&](int&) { do_not_optimize(dot(a, b)); }, n, options.repetitions));
+    }
+    if (options.selected("add"))
+    {
+        record("add", measure([&]() { return V(static_cast<int>(n)); }, [&](V& out) { add(a, b, out); },
+                              n, options.repetitions));
+    }
+    if (options.selected("fill"))
+    {
+        record("fill", measure([&]() { return a; }, [&](V& vec) { fill(vec, T(5)); }, n, options.repetitions));
+    }
+    if (options.selected("push_back"))
+    {
+        record("push_back", measure([]() { return V(); }, [&](V& vec)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                vec.push_back(T(1));
+            }
+        }, n, options.repetitions));
+    }
+}
+
+template<typename T>
+void run_type(const BenchmarkOptions& options, std::vector<Measurement>& results)
+{
+    for (size_t n : options.sizes())
+    {
+        run_container<T, Vector<T> >(options, n, "Vector", results);
+        run_container<T, AlignedVector<T> >(options, n, "AlignedVector", results);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = parse_options(argc, argv);
+
+    bool ok = verify<float>() & verify<double>();
+    if (!ok)
+    {
+        return 1;
+    }
+    std::cerr << "verified alignment and results against Vector\n";
+
+    AlignedVector<float> probe(64 * 1024 * 1024 / sizeof(float), 1.0f);
+    std::cerr << "transparent huge pages: " << huge_page_kb(probe.data()) / 1024 << " of "
+              << probe.size() * sizeof(float) / (1024 * 1024) << " MB\n";
+
+    std::vector<Measurement> results;
+    run_type<float>(options, results);
+    run_type<double>(options, results);
+
+    report(results, options.format, std::cout);
+    return 0;
+}
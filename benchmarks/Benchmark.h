@@ -0,0 +1,164 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ *  Минимален, възпроизводим харнес за бенчмаркове: всяко измерване се повтаря
+ *  няколко пъти, подготовката на състоянието е извън измерваното време, а като
+ *  резултат се взимат медианата и минимумът в наносекунди на операция.
+ */
+
+/**
+ *  Пречи на компилатора да премахне изчисление, чийто резултат не се ползва.
+ */
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ *  Резултат от едно измерване.
+ */
+struct Measurement
+{
+    std::string suite;          // група бенчмаркове, напр. "vector"
+    std::string container;      // "Vector" или "std::vector"
+    std::string type;           // тип на елементите
+    std::string operation;      // измерваната операция
+    size_t size;                // брой елементи във вектора
+    size_t ops;                 // брой операции в едно повторение
+    size_t repetitions;
+    double median_ns;           // медиана на времето за една операция
+    double min_ns;              // най-доброто време за една операция
+};
+
+/**
+ *  Настройки от командния ред:
+ *      --format=csv|json   формат на изхода (по подразбиране csv)
+ *      --min-size=N        най-малък размер (по подразбиране 10)
+ *      --max-size=N        най-голям размер (по подразбиране 10^6, до 10^8)
+ *      --reps=N            брой повторения на всяко измерване (по подразбиране 5)
+ *      --filter=S          изпълнява само операциите, чието име съдържа S
+ */
+struct BenchmarkOptions
+{
+    std::string format = "csv";
+    size_t min_size = 10;
+    size_t max_size = 1000000;
+    size_t repetitions = 5;
+    std::string filter;
+
+    bool selected(const std::string& operation) const
+    {
+        return filter.empty() || operation.find(filter) != std::string::npos;
+    }
+
+    std::vector<size_t> sizes() const
+    {
+        std::vector<size_t> result;
+        for (size_t n = min_size; n <= max_size; n *= 10)
+        {
+            result.push_back(n);
+        }
+        return result;
+    }
+};
+
+inline BenchmarkOptions parse_options(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+
+        if (arg.rfind("--format=", 0) == 0)         options.format = value;
+        else if (arg.rfind("--min-size=", 0) == 0)  options.min_size = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg.rfind("--max-size=", 0) == 0)  options.max_size = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg.rfind("--reps=", 0) == 0)      options.repetitions = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg.rfind("--filter=", 0) == 0)    options.filter = value;
+        else
+        {
+            std::cerr << "unknown option: " << arg << "\n";
+            std::exit(1);
+        }
+    }
+    return options;
+}
+
+/**
+ *  Измерва body(state) repetitions пъти. Преди всяко повторение setup() построява
+ *  ново състояние, а унищожаването му също остава извън измерваното време.
+ *
+ *  @param  setup       -   функция без аргументи, която връща състоянието
+ *  @param  body        -   измерваната функция, приема състоянието по референция
+ *  @param  ops         -   брой операции, които body извършва (за време на операция)
+ */
+template<typename Setup, typename Body>
+Measurement measure(Setup setup, Body body, size_t ops, size_t repetitions)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> samples;
+    for (size_t rep = 0; rep < repetitions; ++rep)
+    {
+        auto state = setup();
+        clock::time_point start = clock::now();
+        body(state);
+        clock::time_point stop = clock::now();
+        do_not_optimize(state);
+
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        samples.push_back(ns / (ops ? ops : 1));
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    Measurement result = {};
+    result.ops = ops;
+    result.repetitions = repetitions;
+    result.median_ns = samples[samples.size() / 2];
+    result.min_ns = samples.front();
+    return result;
+}
+
+/**
+ *  Извежда резултатите като CSV или като JSON масив.
+ */
+inline void report(const std::vector<Measurement>& results, const std::string& format, std::ostream& out)
+{
+    if (format == "json")
+    {
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Measurement& m = results[i];
+            out << "  {\"suite\": \"" << m.suite << "\", \"container\": \"" << m.container
+                << "\", \"type\": \"" << m.type << "\", \"operation\": \"" << m.operation
+                << "\", \"size\": " << m.size << ", \"ops\": " << m.ops
+                << ", \"repetitions\": " << m.repetitions << ", \"median_ns\": " << m.median_ns
+                << ", \"min_ns\": " << m.min_ns << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+    }
+    else
+    {
+        out << "suite,container,type,operation,size,ops,repetitions,median_ns,min_ns\n";
+        for (const Measurement& m : results)
+        {
+            out << m.suite << "," << m.container << "," << m.type << "," << m.operation << ","
+                << m.size << "," << m.ops << "," << m.repetitions << ","
+                << m.median_ns << "," << m.min_ns << "\n";
+        }
+    }
+}
+
+#endif // BENCHMARK_H
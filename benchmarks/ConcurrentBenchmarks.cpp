@@ -0,0 +1,340 @@
+#include "Benchmark.h"
+#include "ConcurrentVector.h"
+#include "Vector.h"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ *  Стрес тест и бенчмарк на мащабирането на ConcurrentVector спрямо Vector,
+ *  защитен с mutex, за 1, 2, 4, ... нишки (до двойния брой хардуерни нишки).
+ *
+ *  Преди измерванията стрес тестът пуска няколко пишещи нишки (push_back, emplace_back
+ *  и grow_by) и една четяща, която непрекъснато проверява всички елементи под size();
+ *  накрая всеки добавен елемент трябва да присъства точно веднъж. Отделно се проверяват
+ *  capacity() и size() след изключения при заделяне и конструиране. При грешка
+ *  програмата спира с код 1. Пример:
+ *
+ *      concurrent_benchmarks --max-size=10000000 --filter=concurrent
+ */
+
+/**
+ *  Стойност на seq-ия елемент на нишката writer; 0 никога не е валидна стойност.
+ */
+std::uint64_t encode(size_t writer, size_t seq)
+{
+    return (std::uint64_t(writer) << 32) | (seq + 1);
+}
+
+std::vector<unsigned> thread_counts()
+{
+    unsigned hardware = std::max(2u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned threads = 1; threads <= 2 * hardware; threads *= 2)
+    {
+        counts.push_back(threads);
+    }
+    return counts;
+}
+
+/**
+ *  На всеки седми елемент пишещите нишки добавят група от 4 с grow_by.
+ */
+size_t group_size(size_t seq, size_t per_writer)
+{
+    return seq % 7 == 3 && seq + 4 <= per_writer ? 4 : 1;
+}
+
+bool stress(size_t writers, size_t per_writer)
+{
+    ConcurrentVector<std::uint64_t> vec;
+    ConcurrentVector<std::string> names;
+    std::atomic<bool> done{false};
+    std::atomic<bool> ok{true};
+
+    // четящата нишка вижда само готови елементи с валидни стойности
+    std::thread reader([&]()
+    {
+        while (!done.load())
+        {
+            size_t n = vec.size();
+            for (size_t i = 0; i < n; ++i)
+            {
+                std::uint64_t value = vec[i];
+                if (value == 0 || (value >> 32) >= writers || (value & 0xffffffffu) > per_writer)
+                {
+                    ok = false;
+                }
+            }
+            size_t m = names.size();
+            if (m && names[m - 1].empty())
+            {
+                ok = false;
+            }
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < writers; ++w)
+    {
+        threads.emplace_back([&vec, &names, &ok, w, per_writer]()
+        {
+            size_t previous = 0;
+            for (size_t seq = 0; seq < per_writer; )
+            {
+                size_t index = previous;
+                size_t count = group_size(seq, per_writer);
+                if (count > 1)
+                {
+                    index = vec.grow_by(count, encode(w, seq));     // count еднакви елемента
+                }
+                else if (seq % 2)
+                {
+                    index = vec.push_back(encode(w, seq));
+                }
+                else if (vec.emplace_back(encode(w, seq)) != encode(w, seq))
+                {
+                    ok = false;
+                }
+                if (index < previous)
+                {
+                    ok = false;                 // индексите на една нишка растат
+                }
+                previous = index;
+                seq += count;
+                names.push_back("writer-" + std::to_string(w) + "-" + std::to_string(seq));
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    done = true;
+    reader.join();
+
+    // всяка стойност се среща толкова пъти, колкото е добавена
+    std::vector<std::vector<size_t> > seen(writers, std::vector<size_t>(per_writer, 0));
+    for (size_t i = 0; i < vec.size(); ++i)
+    {
+        std::uint64_t value = vec[i];
+        size_t writer = value >> 32, seq = (value & 0xffffffffu) - 1;
+        if (writer >= writers || seq >= per_writer)
+        {
+            return false;
+        }
+        ++seen[writer][seq];
+    }
+    size_t operations = 0;
+    for (size_t w = 0; w < writers; ++w)
+    {
+        for (size_t seq = 0; seq < per_writer; seq += group_size(seq, per_writer), ++operations)
+        {
+            if (seen[w][seq] != group_size(seq, per_writer))
+            {
+                ok = false;
+            }
+        }
+    }
+    return ok && vec.size() == writers * per_writer && names.size() == operations;
+}
+
+/**
+ *  Алокатор, който хвърля std::bad_alloc при следващите failures заделяния.
+ */
+template<typename T>
+struct FailingAllocator
+{
+    using value_type = T;
+    static int failures;
+
+    FailingAllocator() = default;
+    template<typename U>
+    FailingAllocator(const FailingAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        if (failures > 0)
+        {
+            --failures;
+            throw std::bad_alloc();
+        }
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n)     { std::allocator<T>().deallocate(p, n); }
+};
+
+template<typename T>
+int FailingAllocator<T>::failures = 0;
+
+template<typename T, typename U>
+bool operator==(const FailingAllocator<T>&, const FailingAllocator<U>&) { return true; }
+
+template<typename T, typename U>
+bool operator!=(const FailingAllocator<T>&, const FailingAllocator<U>&) { return false; }
+
+/**
+ *  Елемент, чийто конструктор хвърля при отрицателна стойност.
+ */
+struct Picky
+{
+    explicit Picky(int value) : m_value(value)
+    {
+        if (value < 0)
+        {
+            throw std::invalid_argument("Picky: negative value");
+        }
+    }
+
+    int m_value;
+};
+
+/**
+ *  Еднонишкови проверки на поведението при изключения:
+ *  - сегмент 1 може да е заделен, докато сегмент 0 не е (заделянето му е хвърлило),
+ *    и capacity() трябва да отчита най-високия заделен сегмент;
+ *  - слот, чийто конструктор е хвърлил, спира size(), докато не се извика clear().
+ */
+bool verify_failures()
+{
+    using Failing = ConcurrentVector<int, FailingAllocator<int> >;
+    bool ok = true;
+
+    Failing vec;
+    FailingAllocator<int>::failures = 1;
+    bool thrown = false;
+    try
+    {
+        vec.grow_by(32, 1);                 // индекси 0..31, сегмент 0
+    }
+    catch (const std::bad_alloc&)
+    {
+        thrown = true;
+    }
+    size_t index = vec.push_back(2);        // индекс 32, сегмент 1
+    ok = thrown && index == 32 && vec[32] == 2 && vec.size() == 0 && vec.capacity() == 32 + 64;
+    vec.clear();
+    vec.push_back(3);
+    ok = ok && vec.size() == 1 && vec[0] == 3 && vec.capacity() == 96;
+
+    ConcurrentVector<Picky> picky;
+    picky.emplace_back(1);
+    thrown = false;
+    try
+    {
+        picky.emplace_back(-1);
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown = true;
+    }
+    Picky& after = picky.emplace_back(2);
+    ok = ok && thrown && after.m_value == 2 && picky.size() == 1;
+    picky.clear();
+    picky.emplace_back(4);
+    ok = ok && picky.size() == 1 && picky[0].m_value == 4;
+
+    if (!ok)
+    {
+        std::cerr << "exception check failed\n";
+    }
+    return ok;
+}
+
+/**
+ *  Измерва добавянето на n елемента от threads нишки.
+ */
+template<typename Setup, typename Push>
+Measurement measure_push(size_t n, unsigned threads, size_t repetitions, Setup setup, Push push)
+{
+    return measure(setup, [&](auto& state)
+    {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&state, &push, t, n, threads]()
+            {
+                for (size_t i = t; i < n; i += threads)
+                {
+                    push(*state, i);
+                }
+            });
+        }
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }, n, repetitions);
+}
+
+struct LockedVector
+{
+    std::mutex mutex;
+    Vector<std::uint64_t> vec;
+};
+
+void run_suite(const BenchmarkOptions& options, size_t n, std::vector<Measurement>& results)
+{
+    for (unsigned threads : thread_counts())
+    {
+        auto record = [&](const char* container, Measurement m)
+        {
+            m.suite = "concurrent";
+            m.container = container;
+            m.type = "uint64";
+            m.operation = "push_back/" + std::to_string(threads) + "t";
+            m.size = n;
+            results.push_back(m);
+        };
+
+        if (options.selected("concurrent"))
+        {
+            record("ConcurrentVector", measure_push(n, threads, options.repetitions,
+                []() { return std::make_unique<ConcurrentVector<std::uint64_t> >(); },
+                [](ConcurrentVector<std::uint64_t>& vec, size_t i) { vec.push_back(i); }));
+        }
+        if (options.selected("mutex"))
+        {
+            record("mutex+Vector", measure_push(n, threads, options.repetitions,
+                []() { return std::make_unique<LockedVector>(); },
+                [](LockedVector& locked, size_t i)
+                {
+                    std::lock_guard<std::mutex> lock(locked.mutex);
+                    locked.vec.push_back(i);
+                }));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = parse_options(argc, argv);
+
+    bool ok = true;
+    for (unsigned threads : thread_counts())
+    {
+        ok = stress(threads, 20000) && ok;
+    }
+    ok = verify_failures() && ok;
+    if (!ok)
+    {
+        std::cerr << "self-checks failed\n";
+        return 1;
+    }
+    std::cerr << "stress test and exception checks passed\n";
+
+    std::vector<Measurement> results;
+    for (size_t n : options.sizes())
+    {
+        run_suite(options, n, results);
+    }
+
+    report(results, options.format, std::cout);
+    return 0;
+}
@@ -0,0 +1,393 @@
+#include "Benchmark.h"
+#include "FlatMap.h"
+#include "FlatSet.h"
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ *  Бенчмаркове на FlatMap спрямо std::map с ключове uint64:
+ *  - build        - построяване от n двойки (насипно срещу insert на всяка);
+ *  - find         - n търсения на налични ключове в случаен ред;
+ *  - miss         - n търсения на липсващи ключове;
+ *  - insert_batch - добавяне на n / 16 нови двойки към таблица с n двойки; за
+ *                   сравнение и FlatMap с emplace на всяка (само до 100000).
+ *
+ *  Преди измерванията FlatMap и FlatSet се сверяват със std::map и std::set при
+ *  случайни поредици от операции, а FlatMap се проверява и при изключения от
+ *  стойностите; при разминаване програмата спира с код 1. Пример:
+ *
+ *      flat_benchmarks --max-size=10000000 --filter=find
+ */
+
+std::uint64_t make_key(size_t i)
+{
+    return (i * 0x9E3779B97F4A7C15ull) & ~1ull;       // четни ключове; липсващите са нечетни
+}
+
+Vector<std::pair<std::uint64_t, std::uint64_t> > make_items(size_t first, size_t n)
+{
+    Vector<std::pair<std::uint64_t, std::uint64_t> > items;
+    items.reserve(n);
+    for (size_t i = first; i < first + n; ++i)
+    {
+        items.push_back(std::make_pair(make_key(i), static_cast<std::uint64_t>(i)));
+    }
+    return items;
+}
+
+/**
+ *  Ключове за търсене: всеки наличен ключ веднъж, в разбъркан ред.
+ */
+Vector<std::uint64_t> make_probes(size_t n, std::uint64_t flip)
+{
+    Vector<std::uint64_t> probes;
+    probes.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        probes.push_back(make_key(i) | flip);
+    }
+    std::uint64_t state = 88172645463325252ull;
+    for (size_t i = n; i > 1; --i)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        std::swap(probes[static_cast<int>(i - 1)], probes[static_cast<int>(state % i)]);
+    }
+    return probes;
+}
+
+template<typename Map>
+std::uint64_t lookup_all(const Map& map, const Vector<std::uint64_t>& probes)
+{
+    std::uint64_t total = 0;
+    for (int i = 0; i < probes.size(); ++i)
+    {
+        auto it = map.find(probes[i]);
+        total += it == map.end() ? 0 : it->second + 1;
+    }
+    return total;
+}
+
+std::uint64_t lookup_all(const FlatMap<std::uint64_t, std::uint64_t>& map, const Vector<std::uint64_t>& probes)
+{
+    std::uint64_t total = 0;
+    for (int i = 0; i < probes.size(); ++i)
+    {
+        const std::uint64_t* value = map.find(probes[i]);
+        total += value ? *value + 1 : 0;
+    }
+    return total;
+}
+
+template<typename K, typename V>
+bool same(const FlatMap<K, V>& flat, const std::map<K, V>& expected)
+{
+    if (flat.size() != static_cast<int>(expected.size()))
+    {
+        return false;
+    }
+    int i = 0;
+    for (const auto& [key, value] : expected)
+    {
+        if (flat.key(i) != key || flat.value(i) != value)
+        {
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+template<typename K>
+bool same(const FlatSet<K>& flat, const std::set<K>& expected)
+{
+    return flat.size() == static_cast<int>(expected.size()) && std::equal(flat.begin(), flat.end(), expected.begin());
+}
+
+/**
+ *  Случайна поредица от единични и групови операции с малки ключове (за да има
+ *  много повторения) върху FlatMap/FlatSet и std::map/std::set.
+ */
+bool verify(unsigned seed, int range)
+{
+    std::uint64_t state = seed * 2654435761u + 1;
+    auto next = [&state](int bound)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<int>((state >> 33) % static_cast<std::uint64_t>(bound));
+    };
+
+    std::vector<std::pair<int, std::string> > initial;
+    for (int i = next(range); i > 0; --i)
+    {
+        initial.emplace_back(next(range), std::to_string(i));
+    }
+    FlatMap<int, std::string> flat(initial.begin(), initial.end());
+    std::map<int, std::string> expected(initial.begin(), initial.end());
+
+    std::vector<int> initial_keys;
+    for (const auto& item : initial)
+    {
+        initial_keys.push_back(item.first);
+    }
+    FlatSet<int> flat_set(initial_keys.begin(), initial_keys.end());
+    std::set<int> expected_set(initial_keys.begin(), initial_keys.end());
+
+    bool ok = same(flat, expected) && same(flat_set, expected_set);
+    for (int step = 0; ok && step < 200; ++step)
+    {
+        int key = next(range);
+        switch (next(6))
+        {
+        case 0:
+            ok = flat.emplace(key, std::to_string(step)) == expected.emplace(key, std::to_string(step)).second &&
+                 flat_set.insert(key) == expected_set.insert(key).second;
+            break;
+        case 1:
+            ok = flat.erase(key) == expected.erase(key) && flat_set.erase(key) == expected_set.erase(key);
+            break;
+        case 2:
+            flat[key] += "+";
+            expected[key] += "+";
+            break;
+        case 3:
+        {
+            std::vector<std::pair<int, std::string> > batch;
+            for (int i = next(20); i > 0; --i)
+            {
+                batch.emplace_back(next(range) + (next(4) ? 0 : range), "b" + std::to_string(step));
+            }
+            flat.insert(batch.begin(), batch.end());
+            expected.insert(batch.begin(), batch.end());
+            std::vector<int> keys;
+            for (const auto& item : batch)
+            {
+                keys.push_back(item.first);
+            }
+            flat_set.insert(keys.begin(), keys.end());
+            expected_set.insert(keys.begin(), keys.end());
+            break;
+        }
+        case 4:
+        {
+            const auto& view = flat;
+            auto it = expected.find(key);
+            const std::string* value = view.find(key);
+            ok = (it == expected.end() ? !value && !flat.contains(key) : value && *value == it->second) &&
+                 flat.lower_bound(key) == static_cast<int>(std::distance(expected.begin(), expected.lower_bound(key))) &&
+                 flat_set.contains(key) == (expected_set.count(key) == 1);
+            break;
+        }
+        default:
+        {
+            bool thrown = false;
+            try
+            {
+                ok = flat.at(key) == expected.at(key);
+            }
+            catch (const std::out_of_range&)
+            {
+                thrown = true;
+            }
+            ok = ok && thrown == (expected.count(key) == 0);
+            break;
+        }
+        }
+        ok = ok && same(flat, expected) && same(flat_set, expected_set);
+    }
+
+    if (!ok)
+    {
+        std::cerr << "mismatch: seed=" << seed << " range=" << range << "\n";
+    }
+    return ok;
+}
+
+/**
+ *  Стойност, чието преместване хвърля, след като бъдат изчерпани moves_left премествания.
+ *  Успешно преместеният обект остава с -1.
+ */
+struct Fragile
+{
+    static int moves_left;
+
+    Fragile(int value = 0) : m_value(value) {}
+    Fragile(const Fragile& other) = default;
+    Fragile(Fragile&& other) : m_value(other.m_value)
+    {
+        if (moves_left-- == 0)
+        {
+            throw std::runtime_error("Fragile: move failed");
+        }
+        other.m_value = -1;
+    }
+    Fragile& operator=(const Fragile& other) = default;
+    Fragile& operator=(Fragile&& other) = default;
+
+    int m_value;
+};
+
+int Fragile::moves_left = -1;
+
+/**
+ *  Добавяне на двойки, при което преместването на k-тата стойност хвърля, за всяко k:
+ *  ключовете и стойностите трябва да останат успоредни, търсенето - коректно, а
+ *  наличните двойки - непокътнати. Обхваща и добавянето в края, и общото сливане.
+ */
+bool verify_exception_safety()
+{
+    bool ok = true;
+    for (int append = 0; append < 2; ++append)
+    {
+        for (int k = 0; ok; ++k)
+        {
+            FlatMap<int, Fragile> flat{{10, Fragile(10)}, {20, Fragile(20)}, {30, Fragile(30)}};
+            std::vector<std::pair<int, Fragile> > batch;
+            for (int i = 1; i <= 8; ++i)
+            {
+                batch.emplace_back(append ? 30 + i : 5 * i, Fragile(i));
+            }
+
+            bool thrown = false;
+            Fragile::moves_left = k;
+            try
+            {
+                flat.insert(batch.begin(), batch.end());
+            }
+            catch (const std::runtime_error&)
+            {
+                thrown = true;
+            }
+            Fragile::moves_left = -1;
+
+            ok = flat.keys().size() == flat.values().size() && flat.size() >= 3 &&
+                 (thrown || flat.size() == (append ? 11 : 8));
+            for (int i = 0; ok && i < flat.size(); ++i)
+            {
+                ok = flat.index_of(flat.key(i)) == i;
+            }
+            for (int key : {10, 20, 30})
+            {
+                int index = flat.index_of(key);
+                ok = ok && index >= 0 && flat.values()[index].m_value == key;
+            }
+            if (!thrown)
+            {
+                break;
+            }
+        }
+    }
+
+    if (!ok)
+    {
+        std::cerr << "FlatMap exception safety check failed\n";
+    }
+    return ok;
+}
+
+void run_suite(const BenchmarkOptions& options, size_t n, std::vector<Measurement>& results)
+{
+    using Flat = FlatMap<std::uint64_t, std::uint64_t>;
+    using Map = std::map<std::uint64_t, std::uint64_t>;
+
+    const Vector<std::pair<std::uint64_t, std::uint64_t> > items = make_items(0, n);
+    const Vector<std::pair<std::uint64_t, std::uint64_t> > batch = make_items(n, n / 16);
+    const Vector<std::uint64_t> hits = make_probes(n, 0);
+    const Vector<std::uint64_t> misses = make_probes(n, 1);
+    const auto* begin = items.data();
+    const auto* end = items.data() + items.size();
+    const Flat flat(begin, end);
+    const Map map(begin, end);
+    auto none = []() { return 0; };
+
+    auto record = [&](const char* container, const char* operation, Measurement m)
+    {
+        m.suite = "flat";
+        m.container = container;
+        m.type = "uint64";
+        m.operation = operation;
+        m.size = n;
+        results.push_back(m);
+    };
+
+    if (lookup_all(flat, hits) != lookup_all(map, hits) || lookup_all(flat, misses) != 0)
+    {
+        std::cerr << "lookup mismatch: size=" << n << "\n";
+        std::exit(1);
+    }
+
+    if (options.selected("build"))
+    {
+        record("std::map", "build", measure(none, [&](int&) { Map built(begin, end); do_not_optimize(built); },
+                                            n, options.repetitions));
+        record("FlatMap", "build", measure(none, [&](int&) { Flat built(begin, end); do_not_optimize(built); },
+                                           n, options.repetitions));
+    }
+    if (options.selected("find"))
+    {
+        record("std::map", "find", measure(none, [&](int&) { do_not_optimize(lookup_all(map, hits)); },
+                                           n, options.repetitions));
+        record("FlatMap", "find", measure(none, [&](int&) { do_not_optimize(lookup_all(flat, hits)); },
+                                          n, options.repetitions));
+    }
+    if (options.selected("miss"))
+    {
+        record("std::map", "miss", measure(none, [&](int&) { do_not_optimize(lookup_all(map, misses)); },
+                                           n, options.repetitions));
+        record("FlatMap", "miss", measure(none, [&](int&) { do_not_optimize(lookup_all(flat, misses)); },
+                                          n, options.repetitions));
+    }
+    if (options.selected("insert_batch") && batch.size())
+    {
+        const size_t ops = static_cast<size_t>(batch.size());
+        record("std::map", "insert_batch", measure([&]() { return map; }, [&](Map& table)
+        {
+            table.insert(batch.data(), batch.data() + batch.size());
+        }, ops, options.repetitions));
+        record("FlatMap", "insert_batch", measure([&]() { return flat; }, [&](Flat& table)
+        {
+            table.insert(batch.data(), batch.data() + batch.size());
+        }, ops, options.repetitions));
+        if (n <= 100000)
+        {
+            record("FlatMap (emplace)", "insert_batch", measure([&]() { return flat; }, [&](Flat& table)
+            {
+                for (int i = 0; i < batch.size(); ++i)
+                    table.emplace(batch[i].first, batch[i].second);
+            }, ops, options.repetitions));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = parse_options(argc, argv);
+
+    bool ok = true;
+    for (unsigned seed = 0; seed < 200; ++seed)
+    {
+        ok = verify(seed, 1 + static_cast<int>(seed % 50)) && ok;
+    }
+    ok = verify_exception_safety() && ok;
+    if (!ok)
+    {
+        return 1;
+    }
+    std::cerr << "verified against std::map and std::set and under exceptions\n";
+
+    std::vector<Measurement> results;
+    for (size_t n : options.sizes())
+    {
+        run_suite(options, n, results);
+    }
+
+    report(results, options.format, std::cout);
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include "Benchmark.h"
+#include "MappedVector.h"
+#include "Vector.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+/**
+ *  Бенчмаркове на MappedVector спрямо Vector, зареждан от същия файл с четене:
+ *  - open      - отваряне на файла (mmap срещу четене на целия файл във Vector);
+ *  - open_scan - отваряне и сумиране на всички елементи;
+ *  - push_back - запис на n елемента във файл срещу push_back във Vector.
+ *
+ *  Преди измерванията съдържанието се сверява след затваряне и повторно отваряне;
+ *  при разминаване програмата спира с код 1. Файловете са във временната
+ *  директория (TMPDIR или /tmp). Пример:
+ *
+ *      mapped_benchmarks --max-size=1000000000 --filter=open
+ */
+
+std::uint64_t make_value(size_t i)
+{
+    return (i * 0x9E3779B97F4A7C15ull) >> 20;
+}
+
+std::string temp_path(const char* name)
+{
+    const char* dir = std::getenv("TMPDIR");
+    return std::string(dir && *dir ? dir : "/tmp") + "/mapped_benchmarks_" + std::to_string(::getpid()) + "_" + name;
+}
+
+void write_file(const std::string& path, size_t n)
+{
+    MappedVector<std::uint64_t> vec(path, MappedMode::create);
+    vec.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        vec.push_back(make_value(i));
+    }
+}
+
+/**
+ *  Зарежда файла във Vector така, както се зарежда без mmap: четене след заглавието.
+ */
+Vector<std::uint64_t> read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    MappedHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    Vector<std::uint64_t> vec;
+    vec.resize(header.size);
+    in.read(reinterpret_cast<char*>(vec.data()), header.size * sizeof(std::uint64_t));
+    return vec;
+}
+
+template<typename V>
+std::uint64_t checksum(const V& vec)
+{
+    std::uint64_t total = 0;
+    for (int i = 0; i < vec.size(); ++i)
+    {
+        total += vec[i];
+    }
+    return total;
+}
+
+/**
+ *  Записва n елемента, отваря файла отново и сверява съдържанието, включително
+ *  след resize, pop_back и shrink_to_fit.
+ */
+bool verify(size_t n)
+{
+    std::string path = temp_path("verify");
+    write_file(path, n);
+
+    bool ok = true;
+    {
+        MappedVector<std::uint64_t> vec(path, MappedMode::read_only);
+        ok = ok && vec.read_only() && vec.size() == static_cast<int>(n) && vec.capacity() == static_cast<int>(n);
+        for (size_t i = 0; ok && i < n; ++i)
+        {
+            ok = vec[static_cast<int>(i)] == make_value(i);
+        }
+        ok = ok && checksum(vec) == checksum(read_file(path));
+    }
+    {
+        MappedVector<std::uint64_t> vec(path);
+        vec.resize(n + 100, 7);
+        vec.pop_back();
+        vec.push_back(vec[0]);
+        vec.resize(n + 50);
+        vec.shrink_to_fit();
+        vec.flush();
+    }
+    {
+        MappedVector<std::uint64_t> vec(path, MappedMode::read_only);
+        ok = ok && vec.size() == static_cast<int>(n + 50);
+        for (size_t i = 0; ok && i < n + 50; ++i)
+        {
+            ok = vec[static_cast<int>(i)] == (i < n ? make_value(i) : i == n + 99 ? make_value(0) : 7);
+        }
+    }
+    std::remove(path.c_str());
+
+    if (!ok)
+    {
+        std::cerr << "mismatch: size=" << n << "\n";
+    }
+    return ok;
+}
+
+void run_suite(const BenchmarkOptions& options, size_t n, std::vector<Measurement>& results)
+{
+    std::string path = temp_path("data");
+    write_file(path, n);
+    auto none = []() { return 0; };
+
+    for (bool mapped : {false, true})
+    {
+        auto record = [&](const char* operation, Measurement m)
+        {
+            m.suite = "mapped";
+            m.container = mapped ? "MappedVector" : "Vector";
+            m.type = "uint64";
+            m.operation = operation;
+            m.size = n;
+            results.push_back(m);
+        };
+
+        if (options.selected("open"))
+        {
+            record("open", measure(none, [&](int&)
+            {
+                if (mapped)
+                {
+                    MappedVector<std::uint64_t> vec(path, MappedMode::read_only);
+                    do_not_optimize(vec);
+                }
+                else
+                {
+                    Vector<std::uint64_t> vec = read_file(path);
+                    do_not_optimize(vec);
+                }
+            }, 1, options.repetitions));
+        }
+        if (options.selected("open_scan"))
+        {
+            record("open_scan", measure(none, [&](int&)
+            {
+                std::uint64_t total = mapped ? checksum(MappedVector<std::uint64_t>(path, MappedMode::read_only))
+                                             : checksum(read_file(path));
+                do_not_optimize(total);
+            }, n, options.repetitions));
+        }
+        if (options.selected("push_back"))
+        {
+            std::string out = temp_path("push_back");
+            record("push_back", measure(none, [&](int&)
+            {
+                if (mapped)
+                {
+                    MappedVector<std::uint64_t> vec(out, MappedMode::create);
+                    for (size_t i = 0; i < n; ++i)
+                        vec.push_back(make_value(i));
+                }
+                else
+                {
+                    Vector<std::uint64_t> vec;
+                    for (size_t i = 0; i < n; ++i)
+                        vec.push_back(make_value(i));
+                    do_not_optimize(vec);
+                }
+            }, n, options.repetitions));
+            std::remove(out.c_str());
+        }
+    }
+    std::remove(path.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = parse_options(argc, argv);
+
+    bool ok = true;
+    for (size_t n : {0, 1, 1000, 100003})
+    {
+        ok = verify(n) && ok;
+    }
+    if (!ok)
+    {
+        return 1;
+    }
+    std::cerr << "verified after reopening\n";
+
+    std::vector<Measurement> results;
+    for (size_t n : options.sizes())
+    {
+        run_suite(options, n, results);
+    }
+
+    report(results, options.format, std::cout);
+    return 0;
+}
@@ -0,0 +1,271 @@
+#include "Benchmark.h"
+#include "VectorNumeric.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+/**
+ *  Бенчмаркове на числените операции от VectorNumeric.h за всяко ниво на
+ *  векторизация, което процесорът поддържа, спрямо скаларните ядра.
+ *
+ *  Преди измерванията всяко ниво се сверява със скаларния вариант за всички
+ *  поддържани типове и за размери около границите на регистрите; при разминаване
+ *  програмата спира с код 1. Пример:
+ *
+ *      numeric_benchmarks --format=json --max-size=10000000 --filter=sum
+ */
+
+template<typename T> const char* type_name();
+template<> const char* type_name<std::int8_t>()     { return "int8"; }
+template<> const char* type_name<std::uint8_t>()    { return "uint8"; }
+template<> const char* type_name<std::int16_t>()    { return "int16"; }
+template<> const char* type_name<std::int32_t>()    { return "int32"; }
+template<> const char* type_name<std::uint32_t>()   { return "uint32"; }
+template<> const char* type_name<std::int64_t>()    { return "int64"; }
+template<> const char* type_name<float>()           { return "float"; }
+template<> const char* type_name<double>()          { return "double"; }
+
+/**
+ *  Малки цели стойности в [-3, 4]: сумите и произведенията остават точни и при
+ *  числа с плаваща запетая, затова векторизираните резултати трябва да съвпадат
+ *  бит по бит със скаларните.
+ */
+template<typename T>
+T make_value(size_t i)
+{
+    return static_cast<T>(static_cast<int>(static_cast<std::uint32_t>(i * 2654435761u) >> 29) - 3);
+}
+
+template<typename T>
+Vector<T> make_vector(size_t n, size_t seed)
+{
+    Vector<T> vec;
+    vec.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        vec.push_back(make_value<T>(i + seed));
+    }
+    return vec;
+}
+
+std::vector<SimdLevel> supported_levels()
+{
+    std::vector<SimdLevel> levels;
+    for (SimdLevel level : {SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2, SimdLevel::avx512})
+    {
+        if (level <= detected_simd_level())
+        {
+            levels.push_back(level);
+        }
+    }
+    return levels;
+}
+
+/**
+ *  Резултатите на всички операции при текущото ниво, за сравнение между нивата.
+ */
+template<typename T>
+struct Outcome
+{
+    T sum, dot, min, max;
+    size_t count;
+    int find_present, find_absent;
+    Vector<T> fill, resized, added, subtracted, multiplied, prefix;
+
+    bool operator==(const Outcome& other) const
+    {
+        return sum == other.sum && dot == other.dot && min == other.min && max == other.max &&
+               count == other.count && find_present == other.find_present && find_absent == other.find_absent &&
+               same(fill, other.fill) && same(resized, other.resized) && same(added, other.added) &&
+               same(subtracted, other.subtracted) && same(multiplied, other.multiplied) && same(prefix, other.prefix);
+    }
+
+    static bool same(const Vector<T>& a, const Vector<T>& b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (int i = 0; i < a.size(); ++i)
+        {
+            if (a[i] != b[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+template<typename T>
+Outcome<T> compute(size_t n)
+{
+    Vector<T> a = make_vector<T>(n, 0);
+    Vector<T> b = make_vector<T>(n, 7);
+
+    Outcome<T> result = {};
+    result.sum = sum(a);
+    result.dot = dot(a, b);
+    result.min = n ? min_value(a) : T();
+    result.max = n ? max_value(a) : T();
+    result.count = count(a, T(1));
+    result.find_present = find(a, n ? a[static_cast<int>(n - 1)] : T());
+    result.find_absent = find(a, T(100));
+
+    result.fill = a;
+    fill(result.fill, T(5));
+    result.resized = Vector<T>(n / 2, T(2));
+    result.resized.resize(n, T(3));
+
+    add(a, b, result.added);
+    subtract(a, b, result.subtracted);
+    multiply(a, b, result.multiplied);
+
+    result.prefix = a;
+    prefix_sum(result.prefix);
+    return result;
+}
+
+/**
+ *  Сверява всяко поддържано ниво със скаларното за тип T.
+ */
+template<typename T>
+bool verify()
+{
+    std::vector<size_t> sizes;
+    for (size_t n = 0; n <= 300; ++n)
+    {
+        sizes.push_back(n);
+    }
+    sizes.push_back(4093);
+    sizes.push_back(100003);
+
+    bool ok = true;
+    for (size_t n : sizes)
+    {
+        set_simd_level_limit(SimdLevel::scalar);
+        Outcome<T> expected = compute<T>(n);
+
+        for (SimdLevel level : supported_levels())
+        {
+            set_simd_level_limit(level);
+            if (!(compute<T>(n) == expected))
+            {
+                std::cerr << "mismatch: type=" << type_name<T>() << " level=" << simd_level_name(level)
+                          << " size=" << n << "\n";
+                ok = false;
+            }
+        }
+    }
+    set_simd_level_limit(SimdLevel::avx512);
+    return ok;
+}
+
+/**
+ *  Измерва операциите за тип T и размер n при всяко поддържано ниво.
+ */
+template<typename T>
+void run_suite(const BenchmarkOptions& options, size_t n, std::vector<Measurement>& results)
+{
+    const Vector<T> a = make_vector<T>(n, 0);
+    const Vector<T> b = make_vector<T>(n, 7);
+    auto none = []() { return 0; };
+
+    for (SimdLevel level : supported_levels())
+    {
+        set_simd_level_limit(level);
+
+        auto record = [&](const char* operation, Measurement m)
+        {
+            m.suite = "numeric";
+            m.container = simd_level_name(level);
+            m.type = type_name<T>();
+            m.operation = operation;
+            m.size = n;
+            results.push_back(m);
+        };
+
+        if (options.selected("sum"))
+        {
+            record("sum", measure(none, [&](int&) { do_not_optimize(sum(a)); }, n, options.repetitions));
+        }
+        if (options.selected("dot"))
+        {
+            record("dot", measure(none, [&](int&) { do_not_optimize(dot(a, b)); }, n, options.repetitions));
+        }
+        if (options.selected("min") && n)
+        {
+            record("min", measure(none, [&](int&) { do_not_optimize(min_value(a)); }, n, options.repetitions));
+        }
+        if (options.selected("max") && n)
+        {
+            record("max", measure(none, [&](int&) { do_not_optimize(max_value(a)); }, n, options.repetitions));
+        }
+        if (options.selected("count"))
+        {
+            record("count", measure(none, [&](int&) { do_not_optimize(count(a, T(1))); }, n, options.repetitions));
+        }
+        if (options.selected("find"))
+        {
+            record("find", measure(none, [&](int&) { do_not_optimize(find(a, T(100))); }, n, options.repetitions));
+        }
+        if (options.selected("add"))
+        {
+            record("add", measure([&]() { return Vector<T>(n); }, [&](Vector<T>& out) { add(a, b, out); },
+                                  n, options.repetitions));
+        }
+        if (options.selected("multiply"))
+        {
+            record("multiply", measure([&]() { return Vector<T>(n); }, [&](Vector<T>& out) { multiply(a, b, out); },
+                                       n, options.repetitions));
+        }
+        if (options.selected("prefix_sum"))
+        {
+            record("prefix_sum", measure([&]() { return a; }, [&](Vector<T>& vec) { prefix_sum(vec); },
+                                         n, options.repetitions));
+        }
+        if (options.selected("fill"))
+        {
+            record("fill", measure([&]() { return a; }, [&](Vector<T>& vec) { fill(vec, T(5)); },
+                                   n, options.repetitions));
+        }
+        if (options.selected("resize"))
+        {
+            record("resize", measure([]() { return Vector<T>(); }, [&](Vector<T>& vec) { vec.resize(n, T(5)); },
+                                     n, options.repetitions));
+        }
+    }
+    set_simd_level_limit(SimdLevel::avx512);
+}
+
+template<typename T>
+void run_type(const BenchmarkOptions& options, std::vector<Measurement>& results)
+{
+    for (size_t n : options.sizes())
+    {
+        run_suite<T>(options, n, results);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = parse_options(argc, argv);
+
+    bool ok = verify<std::int8_t>() & verify<std::uint8_t>() & verify<std::int16_t>() &
+              verify<std::int32_t>() & verify<std::uint32_t>() & verify<std::int64_t>() &
+              verify<float>() & verify<double>();
+    if (!ok)
+    {
+        return 1;
+    }
+    std::cerr << "verified against scalar kernels up to " << simd_level_name(detected_simd_level()) << "\n";
+
+    std::vector<Measurement> results;
+    run_type<std::int32_t>(options, results);
+    run_type<std::int64_t>(options, results);
+    run_type<float>(options, results);
+    run_type<double>(options, results);
+
+    report(results, options.format, std::cout);
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include "Benchmark.h"
+#include "VectorParallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+/**
+ *  Бенчмаркове на паралелните операции от VectorParallel.h и на паралелните
+ *  конструктор и resize на Vector спрямо последователните им варианти.
+ *  Броят нишки е този на default_thread_pool(). Преди измерванията резултатите
+ *  се сверяват с последователните; при разминаване програмата спира с код 1. Пример:
+ *
+ *      parallel_benchmarks --max-size=1000000000 --filter=resize
+ */
+
+std::uint64_t make_value(size_t i)
+{
+    return (i * 0x9E3779B97F4A7C15ull) >> 20;
+}
+
+Vector<std::uint64_t> make_vector(size_t n)
+{
+    Vector<std::uint64_t> vec;
+    vec.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        vec.push_back(make_value(i));
+    }
+    return vec;
+}
+
+bool same(const Vector<std::uint64_t>& a, const Vector<std::uint64_t>& b)
+{
+    return a.size() == b.size() && std::equal(a.data(), a.data() + a.size(), b.data());
+}
+
+/**
+ *  Сверява паралелните операции с последователните за размер n.
+ */
+bool verify(size_t n)
+{
+    const Vector<std::uint64_t> input = make_vector(n);
+    auto square = [](std::uint64_t x) { return x * x; };
+
+    Vector<std::uint64_t> resized, expected_resized;
+    parallel_resize(resized, n, std::uint64_t(7));
+    expected_resized.resize(n, 7);
+
+    Vector<std::uint64_t> copy = parallel_copy(input);
+
+    Vector<std::uint64_t> transformed, expected_transformed = input;
+    parallel_transform(input, transformed, square);
+    std::transform(input.data(), input.data() + n, expected_transformed.data(), square);
+
+    Vector<std::uint64_t> incremented = input, expected_incremented = input;
+    parallel_for(incremented, [](std::uint64_t& x) { ++x; });
+    std::for_each(expected_incremented.data(), expected_incremented.data() + n, [](std::uint64_t& x) { ++x; });
+
+    std::uint64_t total = parallel_reduce(input, std::uint64_t(0));
+    std::uint64_t expected_total = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        expected_total += input[static_cast<int>(i)];
+    }
+
+    Vector<std::uint64_t> sorted = input, expected_sorted = input;
+    parallel_sort(sorted);
+    std::sort(expected_sorted.data(), expected_sorted.data() + n);
+
+    bool ok = same(resized, expected_resized) && same(copy, input) && same(transformed, expected_transformed) &&
+              same(incremented, expected_incremented) && total == expected_total && same(sorted, expected_sorted);
+    if (!ok)
+    {
+        std::cerr << "mismatch: size=" << n << "\n";
+    }
+    return ok;
+}
+
+void run_suite(const BenchmarkOptions& options, size_t n, std::vector<Measurement>& results)
+{
+    using Vec = Vector<std::uint64_t>;
+    const Vec input = make_vector(n);
+    auto empty = []() { return Vec(); };
+    auto filled = [&input]() { return input; };
+    auto none = []() { return 0; };
+
+    for (bool concurrent : {false, true})
+    {
+        auto record = [&](const char* operation, Measurement m)
+        {
+            m.suite = "parallel";
+            m.container = concurrent ? "parallel" : "serial";
+            m.type = "uint64";
+            m.operation = operation;
+            m.size = n;
+            results.push_back(m);
+        };
+
+        if (options.selected("resize"))
+        {
+            record("resize", measure(empty, [&](Vec& vec)
+            {
+                if (concurrent)
+                {
+                    parallel_resize(vec, n, std::uint64_t(7));
+                }
+                else
+                {
+                    vec.resize(n, 7);
+                }
+            }, n, options.repetitions));
+        }
+        if (options.selected("copy"))
+        {
+            record("copy", measure(none, [&](int&)
+            {
+                Vec copy = concurrent ? parallel_copy(input) : Vec(input);
+                do_not_optimize(copy);
+            }, n, options.repetitions));
+        }
+        if (options.selected("for"))
+        {
+            record("for", measure(filled, [&](Vec& vec)
+            {
+                auto increment = [](std::uint64_t& x) { ++x; };
+                if (concurrent)
+                {
+                    parallel_for(vec, increment);
+                }
+                else
+                {
+                    std::for_each(vec.data(), vec.data() + vec.size(), increment);
+                }
+            }, n, options.repetitions));
+        }
+        if (options.selected("transform"))
+        {
+            record("transform", measure(empty, [&](Vec& out)
+            {
+                auto square = [](std::uint64_t x) { return x * x; };
+                if (concurrent)
+                {
+                    parallel_transform(input, out, square);
+                }
+                else
+                {
+                    out.resize(input.size());
+                    std::transform(input.data(), input.data() + input.size(), out.data(), square);
+                }
+            }, n, options.repetitions));
+        }
+        if (options.selected("reduce"))
+        {
+            record("reduce", measure(none, [&](int&)
+            {
+                std::uint64_t total = 0;
+                if (concurrent)
+                {
+                    total = parallel_reduce(input, total);
+                }
+                else
+                {
+                    for (int i = 0; i < input.size(); ++i)
+                        total += input[i];
+                }
+                do_not_optimize(total);
+            }, n, options.repetitions));
+        }
+        if (options.selected("sort"))
+        {
+            record("sort", measure(filled, [&](Vec& vec)
+            {
+                if (concurrent)
+                {
+                    parallel_sort(vec);
+                }
+                else
+                {
+                    std::sort(vec.data(), vec.data() + vec.size());
+                }
+            }, n, options.repetitions));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = parse_options(argc, argv);
+
+    bool ok = true;
+    for (size_t n : {0, 1, 1000, 100003, 3000017})
+    {
+        ok = verify(n) && ok;
+    }
+    if (!ok)
+    {
+        return 1;
+    }
+    std::cerr << "verified against serial algorithms with " << default_thread_pool().concurrency() << " threads\n";
+
+    std::vector<Measurement> results;
+    for (size_t n : options.sizes())
+    {
+        run_suite(options, n, results);
+    }
+
+    report(results, options.format, std::cout);
+    return 0;
+}
@@ -0,0 +1,297 @@
+#include "Benchmark.h"
+#include "VectorSerialization.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ *  Бенчмаркове на VectorWriter/VectorReader спрямо обхождане с operator[] и запис
+ *  на всеки елемент поотделно в std::ofstream (както printVector в main.cpp),
+ *  за uint64 (raw) и std::string (елемент по елемент). Преди измерванията
+ *  записаното се прочита обратно, включително на парчета, а от скъсен файл
+ *  четенето трябва да хвърли, без да остави елементи; при разминаване
+ *  програмата спира с код 1. Файловете са във временната директория. Пример:
+ *
+ *      serialization_benchmarks --max-size=100000000 --filter=write
+ */
+
+template<typename T>
+T make_value(size_t i);
+
+template<>
+std::uint64_t make_value<std::uint64_t>(size_t i)   { return (i * 0x9E3779B97F4A7C15ull) >> 20; }
+
+template<>
+std::string make_value<std::string>(size_t i)       { return "student-name-" + std::to_string(i) + "-padding"; }
+
+template<typename T> const char* type_name();
+template<> const char* type_name<std::uint64_t>()   { return "uint64"; }
+template<> const char* type_name<std::string>()     { return "std::string"; }
+
+template<typename T>
+Vector<T> make_vector(size_t n)
+{
+    Vector<T> vec;
+    vec.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        vec.push_back(make_value<T>(i));
+    }
+    return vec;
+}
+
+std::string temp_path(const char* name)
+{
+    const char* dir = std::getenv("TMPDIR");
+    return std::string(dir && *dir ? dir : "/tmp") + "/serialization_benchmarks_" + std::to_string(::getpid()) + "_" + name;
+}
+
+/**
+ *  Запис и четене без VectorWriter: по един елемент през потоците на стандартната библиотека.
+ */
+void write_loop(std::ofstream& out, const Vector<std::uint64_t>& vec)
+{
+    std::uint64_t size = vec.size();
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    for (int i = 0; i < vec.size(); ++i)
+    {
+        out.write(reinterpret_cast<const char*>(&vec[i]), sizeof(vec[i]));
+    }
+}
+
+void write_loop(std::ofstream& out, const Vector<std::string>& vec)
+{
+    std::uint64_t size = vec.size();
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    for (int i = 0; i < vec.size(); ++i)
+    {
+        std::uint64_t length = vec[i].size();
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(vec[i].data(), length);
+    }
+}
+
+void read_loop(std::ifstream& in, Vector<std::uint64_t>& vec)
+{
+    std::uint64_t size = 0;
+    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    for (std::uint64_t i = 0; i < size; ++i)
+    {
+        std::uint64_t value;
+        in.read(reinterpret_cast<char*>(&value), sizeof(value));
+        vec.push_back(value);
+    }
+}
+
+void read_loop(std::ifstream& in, Vector<std::string>& vec)
+{
+    std::uint64_t size = 0;
+    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    for (std::uint64_t i = 0; i < size; ++i)
+    {
+        std::uint64_t length;
+        in.read(reinterpret_cast<char*>(&length), sizeof(length));
+        std::string value(length, '\0');
+        in.read(&value[0], length);
+        vec.push_back(std::move(value));
+    }
+}
+
+template<typename T>
+bool same(const Vector<T>& a, const Vector<T>& b, int offset = 0)
+{
+    for (int i = 0; i < b.size(); ++i)
+    {
+        if (!(a[offset + i] == b[i]))
+        {
+            return false;
+        }
+    }
+    return a.size() >= offset + b.size();
+}
+
+/**
+ *  Записва вектор с n елемента, чете го обратно наведнъж и на парчета.
+ */
+template<typename T>
+bool verify(size_t n)
+{
+    std::string path = temp_path("verify");
+    const Vector<T> vec = make_vector<T>(n);
+    save_vector(path, vec);
+
+    Vector<T> loaded;
+    load_vector(path, loaded);
+    bool ok = loaded.size() == vec.size() && same(vec, loaded);
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    VectorReader in(fd);
+    ok = ok && in.begin_vector<T>() == n;
+    Vector<T> chunk;
+    int offset = 0;
+    while (size_t count = in.read_chunk(chunk, 1000))
+    {
+        ok = ok && same(vec, chunk, offset);
+        offset += static_cast<int>(count);
+    }
+    ::close(fd);
+    std::remove(path.c_str());
+
+    ok = ok && offset == vec.size();
+    if (!ok)
+    {
+        std::cerr << "mismatch: type=" << type_name<T>() << " size=" << n << "\n";
+    }
+    return ok;
+}
+
+/**
+ *  Записва вектор с n елемента и скъсява файла наполовина: load_vector трябва да
+ *  хвърли, без да остави във вектора елементи (нито неинициализирани, нито
+ *  прочетените преди края), а read_chunk - да запази размера на парчето.
+ */
+template<typename T>
+bool verify_truncated(size_t n)
+{
+    std::string path = temp_path("truncated");
+    save_vector(path, make_vector<T>(n));
+    struct stat info;
+    bool ok = ::stat(path.c_str(), &info) == 0 && ::truncate(path.c_str(), info.st_size / 2) == 0;
+
+    Vector<T> loaded = make_vector<T>(3);
+    bool thrown = false;
+    try
+    {
+        load_vector(path, loaded);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    ok = ok && thrown && loaded.empty();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    VectorReader in(fd);
+    Vector<T> chunk;
+    thrown = false;
+    try
+    {
+        ok = ok && in.begin_vector<T>() == n;
+        while (in.read_chunk(chunk, n / 4 + 1))
+        {
+            ok = ok && chunk.size() == static_cast<int>(n / 4 + 1);
+        }
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    ::close(fd);
+    std::remove(path.c_str());
+
+    ok = ok && thrown && chunk.empty();
+    if (!ok)
+    {
+        std::cerr << "truncated file not rejected: type=" << type_name<T>() << " size=" << n << "\n";
+    }
+    return ok;
+}
+
+template<typename T>
+void run_suite(const BenchmarkOptions& options, size_t n, std::vector<Measurement>& results)
+{
+    const Vector<T> vec = make_vector<T>(n);
+    const std::string path = temp_path("data");
+
+    for (bool bulk : {false, true})
+    {
+        auto record = [&](const char* operation, Measurement m)
+        {
+            m.suite = "serialization";
+            m.container = bulk ? "VectorWriter" : "loop";
+            m.type = type_name<T>();
+            m.operation = operation;
+            m.size = n;
+            results.push_back(m);
+        };
+
+        if (options.selected("write"))
+        {
+            // файлът се изтрива извън измерването: презаписването на файл с O_TRUNC
+            // кара някои файлови системи (ext4) да запишат старите данни на диска
+            auto fresh = [&path]() { return std::remove(path.c_str()); };
+            record("write", measure(fresh, [&](int&)
+            {
+                if (bulk)
+                {
+                    save_vector(path, vec);
+                }
+                else
+                {
+                    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                    write_loop(out, vec);
+                }
+            }, n, options.repetitions));
+        }
+        if (options.selected("read"))
+        {
+            if (bulk)
+            {
+                save_vector(path, vec);
+            }
+            else
+            {
+                std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                write_loop(out, vec);
+            }
+            record("read", measure([]() { return Vector<T>(); }, [&](Vector<T>& loaded)
+            {
+                if (bulk)
+                {
+                    load_vector(path, loaded);
+                }
+                else
+                {
+                    std::ifstream in(path, std::ios::binary);
+                    read_loop(in, loaded);
+                }
+            }, n, options.repetitions));
+        }
+    }
+    std::remove(path.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = parse_options(argc, argv);
+
+    bool ok = true;
+    for (size_t n : {0, 1, 8191, 8193, 100003})
+    {
+        ok = verify<std::uint64_t>(n) && ok;
+        ok = verify<std::string>(n) && ok;
+    }
+    ok = verify_truncated<std::uint64_t>(1000) && ok;
+    ok = verify_truncated<std::string>(1000) && ok;
+    if (!ok)
+    {
+        return 1;
+    }
+    std::cerr << "verified round trips\n";
+
+    std::vector<Measurement> results;
+    for (size_t n : options.sizes())
+    {
+        run_suite<std::uint64_t>(options, n, results);
+        run_suite<std::string>(options, n, results);
+    }
+
+    report(results, options.format, std::cout);
+    return 0;
+}
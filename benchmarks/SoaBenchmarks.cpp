@@ -0,0 +1,282 @@
+#include "Benchmark.h"
+#include "SoaVector.h"
+#include "Vector.h"
+#include "VectorSimd.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ *  Бенчмаркове на SoaVector<std::string, int, double> спрямо Vector от записи
+ *  (като Student в main.cpp, с допълнителна оценка):
+ *  - push_back - добавяне на n записа;
+ *  - sum_age   - сума на едно поле (simd_sum върху колоната срещу цикъл по записите);
+ *  - filter    - брой записи с възраст над прага;
+ *  - sum_where - сума на оценките на записите с възраст над прага (две полета).
+ *
+ *  Преди измерванията операциите на SoaVector се сверяват с Vector от записи;
+ *  при разминаване програмата спира с код 1. Пример:
+ *
+ *      soa_benchmarks --max-size=10000000 --filter=sum_age
+ */
+
+struct Record
+{
+    std::string name;
+    int age;
+    double grade;
+
+    bool operator==(const Record& other) const
+    {
+        return name == other.name && age == other.age && grade == other.grade;
+    }
+};
+
+using Table = SoaVector<std::string, int, double>;
+
+const int AGE_THRESHOLD = 22;
+
+Record make_record(size_t i)
+{
+    std::uint32_t hash = static_cast<std::uint32_t>(i * 2654435761u);
+    return Record{"student-" + std::to_string(i), 18 + static_cast<int>(hash >> 29), 2.0 + (hash >> 30)};
+}
+
+Vector<Record> make_records(size_t n)
+{
+    Vector<Record> vec;
+    vec.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        vec.push_back(make_record(i));
+    }
+    return vec;
+}
+
+Table make_table(size_t n)
+{
+    Table table;
+    table.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        Record record = make_record(i);
+        table.emplace_back(std::move(record.name), record.age, record.grade);
+    }
+    return table;
+}
+
+bool same(const Table& table, const Vector<Record>& records)
+{
+    if (table.size() != records.size())
+    {
+        return false;
+    }
+    int i = 0;
+    for (const auto& [name, age, grade] : table)
+    {
+        if (!(Record{name, age, grade} == records[i++]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int sum_age(const Vector<Record>& records)
+{
+    int total = 0;
+    for (int i = 0; i < records.size(); ++i)
+    {
+        total += records[i].age;
+    }
+    return total;
+}
+
+int sum_age(const Table& table)
+{
+    SoaColumn<const int> ages = table.column<1>();
+    return simd_sum(ages.data(), ages.size());
+}
+
+int filter(const Vector<Record>& records)
+{
+    int count = 0;
+    for (int i = 0; i < records.size(); ++i)
+    {
+        count += records[i].age > AGE_THRESHOLD;
+    }
+    return count;
+}
+
+int filter(const Table& table)
+{
+    int count = 0;
+    for (int age : table.column<1>())
+    {
+        count += age > AGE_THRESHOLD;
+    }
+    return count;
+}
+
+double sum_where(const Vector<Record>& records)
+{
+    double total = 0;
+    for (int i = 0; i < records.size(); ++i)
+    {
+        if (records[i].age > AGE_THRESHOLD)
+            total += records[i].grade;
+    }
+    return total;
+}
+
+double sum_where(const Table& table)
+{
+    SoaColumn<const int> ages = table.column<1>();
+    SoaColumn<const double> grades = table.column<2>();
+    double total = 0;
+    for (int i = 0; i < ages.size(); ++i)
+    {
+        if (ages[i] > AGE_THRESHOLD)
+            total += grades[i];
+    }
+    return total;
+}
+
+/**
+ *  Прилага една и съща поредица от операции върху SoaVector и Vector от записи
+ *  и сверява съдържанието, колоните и сканиращите функции.
+ */
+bool verify(size_t n)
+{
+    Table table = make_table(n);
+    Vector<Record> records = make_records(n);
+    bool ok = same(table, records) && sum_age(table) == sum_age(records) &&
+              filter(table) == filter(records) && sum_where(table) == sum_where(records);
+
+    for (int i = 0; i < 3 && !records.empty(); ++i)
+    {
+        auto [name, age, grade] = table[0];                     // полетата сочат в самия вектор, докато той расте
+        table.emplace_back(name, age, grade);
+        records.push_back(records[0]);
+    }
+    if (records.size() > 5)
+    {
+        table.erase(1);
+        records.erase(1);
+        table.swap_erase(2);
+        records.swap_erase(2);
+        std::get<0>(table[3]) = "renamed";
+        records[3].name = "renamed";
+        table.back() = std::make_tuple(std::string("last"), 99, 1.5);
+        records[records.size() - 1] = Record{"last", 99, 1.5};
+    }
+    ok = ok && same(table, records);
+
+    Table copy = table;
+    bool copied = same(copy, records);
+    table.resize(n / 2);
+    records.resize(n / 2, Record{"", 0, 0.0});
+    table.shrink_to_fit();
+    ok = ok && copied && same(table, records);
+
+    copy = std::move(table);
+    table.resize(2, std::make_tuple(std::string("filled"), 7, 0.5));
+    records.resize(n / 2 + 2, Record{"filled", 7, 0.5});
+    for (int i = 0; i < table.size(); ++i)
+    {
+        copy.push_back(table[i]);
+    }
+    ok = ok && same(copy, records);
+
+    Table listed{std::make_tuple(std::string("Ivan"), 20, 5.0), std::make_tuple(std::string("Petur"), 20, 4.0)};
+    ok = ok && listed.size() == 2 && std::get<0>(listed[1]) == "Petur" && listed.end() - listed.begin() == 2;
+
+    if (!ok)
+    {
+        std::cerr << "mismatch: size=" << n << "\n";
+    }
+    return ok;
+}
+
+void run_suite(const BenchmarkOptions& options, size_t n, std::vector<Measurement>& results)
+{
+    const Vector<Record> records = make_records(n);
+    const Table table = make_table(n);
+    auto none = []() { return 0; };
+
+    for (bool soa : {false, true})
+    {
+        auto record = [&](const char* operation, Measurement m)
+        {
+            m.suite = "soa";
+            m.container = soa ? "SoaVector" : "Vector";
+            m.type = "record";
+            m.operation = operation;
+            m.size = n;
+            results.push_back(m);
+        };
+
+        if (options.selected("push_back"))
+        {
+            record("push_back", measure(none, [&](int&)
+            {
+                if (soa)
+                {
+                    Table built;
+                    for (size_t i = 0; i < n; ++i)
+                        built.push_back(std::make_tuple(records[static_cast<int>(i)].name, records[static_cast<int>(i)].age,
+                                                        records[static_cast<int>(i)].grade));
+                    do_not_optimize(built);
+                }
+                else
+                {
+                    Vector<Record> built;
+                    for (size_t i = 0; i < n; ++i)
+                        built.push_back(records[static_cast<int>(i)]);
+                    do_not_optimize(built);
+                }
+            }, n, options.repetitions));
+        }
+        if (options.selected("sum_age"))
+        {
+            record("sum_age", measure(none, [&](int&) { do_not_optimize(soa ? sum_age(table) : sum_age(records)); },
+                                      n, options.repetitions));
+        }
+        if (options.selected("filter"))
+        {
+            record("filter", measure(none, [&](int&) { do_not_optimize(soa ? filter(table) : filter(records)); },
+                                     n, options.repetitions));
+        }
+        if (options.selected("sum_where"))
+        {
+            record("sum_where", measure(none, [&](int&) { do_not_optimize(soa ? sum_where(table) : sum_where(records)); },
+                                        n, options.repetitions));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = parse_options(argc, argv);
+
+    bool ok = true;
+    for (size_t n : {0, 1, 2, 7, 100, 4093, 100003})
+    {
+        ok = verify(n) && ok;
+    }
+    if (!ok)
+    {
+        return 1;
+    }
+    std::cerr << "verified against Vector of records\n";
+
+    std::vector<Measurement> results;
+    for (size_t n : options.sizes())
+    {
+        run_suite(options, n, results);
+    }
+
+    report(results, options.format, std::cout);
+    return 0;
+}
@@ -0,0 +1,1173 @@
+#include "ArenaAllocator.h"
+#include "Benchmark.h"
+#include "Vector.h"
+#include "SegmentedVector.h"
+#include "SmallVector.h"
+#include "StaticVector.h"
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ *  Бенчмаркове на Vector и SegmentedVector срещу std::vector за int, std::string
+ *  и запис, подобен на Student от main.cpp. Преди измерванията се проверяват
+ *  SmallVector, добавянето на елементи от самия вектор, вмъкването и триенето
+ *  срещу std::vector, StaticVector, разпространяването на алокаторите,
+ *  SegmentedVector и политиките на растеж, а при -DVECTOR_ENABLE_STATS (целта
+ *  vector_benchmarks_stats) и броячите на статистиката; при грешка програмата
+ *  спира с код 1. Пример:
+ *
+ *      vector_benchmarks --format=json --max-size=100000000 --filter=push_back
+ */
+
+struct Student
+{
+    Student(std::string name, int age) : m_name(std::move(name)), m_age(age) {}
+
+    std::string m_name;
+    int m_age;
+};
+
+/**
+ *  Детерминирани стойности, така че всяко изпълнение измерва едни и същи данни.
+ *  Низовете са достатъчно дълги, за да не се поберат в SSO буфера на std::string.
+ */
+template<typename T>
+T make_value(size_t i);
+
+template<>
+int make_value<int>(size_t i)                   { return static_cast<int>(i * 2654435761u); }
+
+template<>
+std::string make_value<std::string>(size_t i)   { return "student-name-" + std::to_string(i) + "-padding"; }
+
+template<>
+Student make_value<Student>(size_t i)           { return Student(make_value<std::string>(i), static_cast<int>(18 + i % 10)); }
+
+/**
+ *  Конструиране на място от аргументи, а не от готов обект.
+ */
+template<typename C>
+void emplace_value(C& vec, size_t i, int*)              { vec.emplace_back(static_cast<int>(i)); }
+
+template<typename C>
+void emplace_value(C& vec, size_t i, std::string*)      { vec.emplace_back(24 + i % 8, static_cast<char>('a' + i % 26)); }
+
+template<typename C>
+void emplace_value(C& vec, size_t i, Student*)          { vec.emplace_back("student-name-padding-xx", static_cast<int>(i % 100)); }
+
+/**
+ *  Адаптери за разликите в интерфейса: Vector работи с индекси, std::vector с итератори.
+ */
+template<typename T>
+void insert_at(Vector<T>& vec, size_t index, const T& value)        { vec.insert(static_cast<int>(index), value); }
+
+template<typename T>
+void insert_at(std::vector<T>& vec, size_t index, const T& value)   { vec.insert(vec.begin() + index, value); }
+
+template<typename T>
+void insert_at(SegmentedVector<T>& vec, size_t index, const T& value) { vec.insert(static_cast<int>(index), value); }
+
+template<typename T>
+void erase_at(Vector<T>& vec, size_t index)                         { vec.erase(static_cast<int>(index)); }
+
+template<typename T>
+void erase_at(std::vector<T>& vec, size_t index)                    { vec.erase(vec.begin() + index); }
+
+template<typename T>
+void erase_at(SegmentedVector<T>& vec, size_t index)                { vec.erase(static_cast<int>(index)); }
+
+template<typename T>
+const char* container_name(const Vector<T>*)                        { return "Vector"; }
+
+template<typename T>
+const char* container_name(const std::vector<T>*)                   { return "std::vector"; }
+
+template<typename T>
+const char* container_name(const SegmentedVector<T>*)               { return "SegmentedVector"; }
+
+template<typename T> const char* type_name();
+template<> const char* type_name<int>()                             { return "int"; }
+template<> const char* type_name<std::string>()                     { return "std::string"; }
+template<> const char* type_name<Student>()                         { return "Student"; }
+
+/**
+ *  Изпълнява всички операции за контейнер C с елементи T и размер n.
+ */
+template<typename C, typename T>
+void run_suite(const BenchmarkOptions& options, size_t n, std::vector<Measurement>& results)
+{
+    std::vector<T> values;
+    values.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        values.push_back(make_value<T>(i));
+    }
+
+    auto filled = [&values, n]()
+    {
+        C vec;
+        for (size_t i = 0; i < n; ++i)
+        {
+            vec.push_back(values[i]);
+        }
+        return vec;
+    };
+    auto empty = []() { return C(); };
+
+    // операциите в средата са O(n) всяка, затова правим ограничен брой от тях
+    const size_t middle_ops = std::min<size_t>(n, 1000);
+
+    auto record = [&](const char* operation, Measurement m)
+    {
+        m.suite = "vector";
+        m.container = container_name(static_cast<C*>(nullptr));
+        m.type = type_name<T>();
+        m.operation = operation;
+        m.size = n;
+        results.push_back(m);
+    };
+
+    if (options.selected("push_back"))
+    {
+        record("push_back", measure(empty, [&](C& vec)
+        {
+            for (size_t i = 0; i < n; ++i)
+                vec.push_back(values[i]);
+        }, n, options.repetitions));
+    }
+
+    if (options.selected("push_back_move"))
+    {
+        record("push_back_move", measure([&]() { return std::make_pair(C(), values); }, [&](std::pair<C, std::vector<T> >& state)
+        {
+            for (size_t i = 0; i < n; ++i)
+                state.first.push_back(std::move(state.second[i]));
+        }, n, options.repetitions));
+    }
+
+    if (options.selected("emplace_back"))
+    {
+        record("emplace_back", measure(empty, [&](C& vec)
+        {
+            for (size_t i = 0; i < n; ++i)
+                emplace_value(vec, i, static_cast<T*>(nullptr));
+        }, n, options.repetitions));
+    }
+
+    if (options.selected("reserve_push_back"))
+    {
+        record("reserve_push_back", measure(empty, [&](C& vec)
+        {
+            vec.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+                vec.push_back(values[i]);
+        }, n, options.repetitions));
+    }
+
+    if (options.selected("insert_middle"))
+    {
+        record("insert_middle", measure(filled, [&](C& vec)
+        {
+            for (size_t i = 0; i < middle_ops; ++i)
+                insert_at(vec, vec.size() / 2, values[i]);
+        }, middle_ops, options.repetitions));
+    }
+
+    if (options.selected("erase_middle"))
+    {
+        record("erase_middle", measure(filled, [&](C& vec)
+        {
+            for (size_t i = 0; i < middle_ops && vec.size() > 0; ++i)
+                erase_at(vec, vec.size() / 2);
+        }, middle_ops, options.repetitions));
+    }
+
+    if (options.selected("resize"))
+    {
+        record("resize", measure(empty, [&](C& vec)
+        {
+            vec.resize(n, values[0]);
+        }, n, options.repetitions));
+    }
+
+    if (options.selected("copy"))
+    {
+        record("copy", measure(filled, [&](C& vec)
+        {
+            C copy(vec);
+            do_not_optimize(copy);
+        }, n, options.repetitions));
+    }
+
+    if (options.selected("move"))
+    {
+        record("move", measure(filled, [&](C& vec)
+        {
+            C moved(std::move(vec));
+            vec = std::move(moved);
+        }, 1, options.repetitions));
+    }
+
+    if (options.selected("shrink_to_fit"))
+    {
+        record("shrink_to_fit", measure([&]()
+        {
+            C vec = filled();
+            vec.resize(n / 2, values[0]);
+            return vec;
+        }, [&](C& vec)
+        {
+            vec.shrink_to_fit();
+        }, n / 2 ? n / 2 : 1, options.repetitions));
+    }
+}
+
+template<typename T>
+void run_type(const BenchmarkOptions& options, std::vector<Measurement>& results)
+{
+    for (size_t n : options.sizes())
+    {
+        run_suite<std::vector<T>, T>(options, n, results);
+        run_suite<Vector<T>, T>(options, n, results);
+        run_suite<SegmentedVector<T>, T>(options, n, results);
+    }
+}
+
+/**
+ *  Елемент, който брои живите си екземпляри, за да се провери, че контейнерите
+ *  унищожават всичко, което са конструирали. Преместеният обект остава с -1.
+ */
+struct Tracked
+{
+    static int live;
+
+    Tracked(int value = 0) : m_value(value)                 { ++live; }
+    Tracked(const Tracked& other) : m_value(other.m_value)  { ++live; }
+    Tracked(Tracked&& other) noexcept : m_value(other.m_value) { other.m_value = -1; ++live; }
+    Tracked& operator=(const Tracked& other)                { m_value = other.m_value; return *this; }
+    Tracked& operator=(Tracked&& other) noexcept            { m_value = other.m_value; other.m_value = -1; return *this; }
+    ~Tracked()                                              { --live; }
+
+    int m_value;
+};
+
+int Tracked::live = 0;
+
+bool operator==(const Tracked& a, const Tracked& b)        { return a.m_value == b.m_value; }
+
+template<>
+Tracked make_value<Tracked>(size_t i)                       { return Tracked(static_cast<int>(i)); }
+
+template<> const char* type_name<Tracked>()                 { return "Tracked"; }
+
+/**
+ *  Дали vec съдържа точно first, first + 1, ..., first + n - 1.
+ */
+template<typename C>
+bool holds(const C& vec, int first, int n)
+{
+    if (vec.size() != n)
+    {
+        return false;
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        if (vec[i].m_value != first + i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename C>
+bool holds(const C& vec, std::initializer_list<int> values)
+{
+    if (vec.size() != static_cast<int>(values.size()))
+    {
+        return false;
+    }
+    int i = 0;
+    for (int value : values)
+    {
+        if (vec[i++].m_value != value)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename C>
+C make_sequence(int first, int n)
+{
+    C vec;
+    for (int i = 0; i < n; ++i)
+    {
+        vec.push_back(Tracked(first + i));
+    }
+    return vec;
+}
+
+/**
+ *  SmallVector: преминаване от вградения буфер в динамичната памет, копиране и
+ *  преместване между двете състояния, връщане във вградения буфер при shrink_to_fit
+ *  и разделяне на алокаторите (копието и преместеният вектор ползват своя буфер).
+ */
+bool verify_small_vector()
+{
+    using Small = SmallVector<Tracked, 4>;
+    bool ok = true;
+    {
+        Small vec;
+        const Tracked* inline_data = vec.data();
+        ok = ok && vec.is_inline() && vec.capacity() == 4;
+        for (int i = 0; i < 4; ++i)
+        {
+            vec.push_back(Tracked(i));
+        }
+        ok = ok && vec.is_inline() && vec.data() == inline_data && holds(vec, 0, 4);
+        vec.push_back(Tracked(4));
+        ok = ok && !vec.is_inline() && vec.capacity() > 4 && holds(vec, 0, 5);
+
+        Small heap_copy(vec);
+        Small inline_copy = make_sequence<Small>(10, 3);
+        Small inline_copy2(inline_copy);
+        ok = ok && !heap_copy.is_inline() && heap_copy.data() != vec.data() && holds(heap_copy, 0, 5) &&
+             inline_copy2.is_inline() && inline_copy2.data() != inline_copy.data() && holds(inline_copy2, 10, 3) &&
+             inline_copy2.get_allocator() != inline_copy.get_allocator();
+
+        const Tracked* heap_data = heap_copy.data();
+        Small stolen(std::move(heap_copy));
+        ok = ok && stolen.data() == heap_data && holds(stolen, 0, 5) &&
+             heap_copy.is_inline() && heap_copy.empty() && heap_copy.capacity() == 4;
+
+        Small moved(std::move(inline_copy2));
+        ok = ok && moved.is_inline() && holds(moved, 10, 3) && inline_copy2.is_inline() && inline_copy2.empty();
+
+        stolen = std::move(moved);                      // в динамичната памет, а източникът е вграден
+        ok = ok && stolen.is_inline() && holds(stolen, 10, 3) && moved.empty();
+        moved = vec;                                    // вграден, а източникът е в динамичната памет
+        ok = ok && !moved.is_inline() && holds(moved, 0, 5);
+        moved = inline_copy;
+        ok = ok && !moved.is_inline() && holds(moved, 10, 3);
+        moved.shrink_to_fit();
+        ok = ok && moved.is_inline() && holds(moved, 10, 3);
+
+        Small large = make_sequence<Small>(20, 12);
+        large.erase(6, 12);
+        large.shrink_to_fit();
+        ok = ok && !large.is_inline() && large.capacity() == 6 && holds(large, 20, 6);
+
+        swap(large, moved);
+        ok = ok && holds(large, 10, 3) && large.is_inline() && holds(moved, 20, 6) && !moved.is_inline();
+
+        // Обикновено копие като Vector не бива да вземе вградения буфер на източника.
+        Vector<Tracked, InlineAllocator<Tracked, 4> > plain(inline_copy);
+        ok = ok && plain.get_allocator().buffer() == nullptr && plain.data() != inline_copy.data() &&
+             holds(plain, 10, 3);
+    }
+    ok = ok && Tracked::live == 0;
+
+    if (!ok)
+    {
+        std::cerr << "SmallVector check failed\n";
+    }
+    return ok;
+}
+
+/**
+ *  Допълва vec и модела expected с нови стойности, докато векторът се напълни,
+ *  така че следващото добавяне да го накара да расте.
+ */
+template<typename T>
+void fill_to_capacity(Vector<T>& vec, std::vector<T>& expected)
+{
+    while (vec.size() < vec.capacity())
+    {
+        T value = make_value<T>(expected.size());
+        vec.push_back(value);
+        expected.push_back(value);
+    }
+}
+
+/**
+ *  push_back, emplace_back и emplace с аргумент, който е елемент на самия вектор,
+ *  точно когато векторът е пълен: int расте с realloc, std::string - с нов буфер.
+ *  Аргументът трябва да бъде прочетен, преди старият буфер да се освободи.
+ */
+template<typename T>
+bool verify_self_reference()
+{
+    Vector<T> vec;
+    std::vector<T> expected;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        vec.push_back(make_value<T>(i));
+        expected.push_back(make_value<T>(i));
+    }
+
+    fill_to_capacity(vec, expected);
+    vec.push_back(vec[0]);
+    expected.push_back(expected[0]);
+
+    fill_to_capacity(vec, expected);
+    vec.emplace_back(vec[vec.size() - 1]);
+    expected.push_back(expected.back());
+
+    fill_to_capacity(vec, expected);
+    vec.emplace(1, vec[vec.size() - 1]);
+    T last = expected.back();
+    expected.insert(expected.begin() + 1, last);
+
+    vec.emplace(0, vec[2]);                         // без растеж: аргументът се измества заедно с опашката
+    T third = expected[2];
+    expected.insert(expected.begin(), third);
+
+    bool ok = vec.size() == static_cast<int>(expected.size());
+    for (int i = 0; ok && i < vec.size(); ++i)
+    {
+        ok = vec[i] == expected[i];
+    }
+
+    if (!ok)
+    {
+        std::cerr << "self-referencing emplace check failed: " << type_name<T>() << "\n";
+    }
+    return ok;
+}
+
+/**
+ *  Добавяне с растеж на Tracked елементи: копие и преместване на елемент от самия
+ *  вектор, временен обект и emplace в средата, като броят на живите екземпляри
+ *  винаги съвпада с размера. Отделно - push_back и emplace на тип, който само се мести.
+ */
+bool verify_emplace()
+{
+    bool ok = verify_self_reference<int>();
+    ok = verify_self_reference<std::string>() && ok;
+    {
+        Vector<Tracked> vec = make_sequence<Vector<Tracked> >(0, 3);
+        auto fill = [&vec]()
+        {
+            while (vec.size() < vec.capacity())
+            {
+                vec.push_back(Tracked(vec.size()));
+            }
+            return vec.size();
+        };
+
+        int n = fill();
+        vec.push_back(vec[1]);
+        ok = ok && vec.size() == n + 1 && vec[1].m_value == 1 && vec[n].m_value == 1 && Tracked::live == vec.size();
+
+        n = fill();
+        vec.push_back(std::move(vec[2]));
+        ok = ok && vec.size() == n + 1 && vec[2].m_value == -1 && vec[n].m_value == 2 && Tracked::live == vec.size();
+
+        n = fill();
+        vec.emplace_back(vec[n - 1]);
+        ok = ok && vec.size() == n + 1 && vec[n].m_value == n - 1 && vec[n - 1].m_value == n - 1 &&
+             Tracked::live == vec.size();
+
+        n = fill();
+        vec.emplace(0, vec[n - 1]);
+        ok = ok && vec.size() == n + 1 && vec[0].m_value == n - 1 && vec[1].m_value == 0 &&
+             vec[n].m_value == n - 1 && Tracked::live == vec.size();
+
+        n = fill();
+        vec.push_back(Tracked(-5));
+        ok = ok && vec.size() == n + 1 && vec[n].m_value == -5 && Tracked::live == vec.size();
+    }
+    ok = ok && Tracked::live == 0;
+
+    {
+        Vector<std::unique_ptr<int> > owners;
+        for (int i = 0; i < 100; ++i)
+        {
+            owners.push_back(std::make_unique<int>(i));
+        }
+        owners.emplace(0, std::make_unique<int>(-1));
+        owners.emplace_back(new int(100));
+        bool intact = owners.size() == 102 && *owners[0] == -1 && *owners[101] == 100;
+        for (int i = 0; intact && i < 100; ++i)
+        {
+            intact = owners[i + 1] && *owners[i + 1] == i;
+        }
+        ok = ok && intact;
+    }
+
+    if (!ok)
+    {
+        std::cerr << "emplace check failed\n";
+    }
+    return ok;
+}
+
+/**
+ *  Вектор от size елемента с място за още spare и същите стойности в модела expected.
+ */
+template<typename T>
+Vector<T> make_filled(int size, int spare, std::vector<T>& expected)
+{
+    Vector<T> vec;
+    vec.reserve(size + spare);
+    expected.clear();
+    for (int i = 0; i < size; ++i)
+    {
+        vec.push_back(make_value<T>(i));
+        expected.push_back(make_value<T>(i));
+    }
+    return vec;
+}
+
+template<typename C, typename T>
+bool same_elements(const C& vec, const std::vector<T>& expected)
+{
+    if (vec.size() != static_cast<int>(expected.size()))
+    {
+        return false;
+    }
+    for (int i = 0; i < vec.size(); ++i)
+    {
+        if (!(vec[i] == expected[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ *  insert(index, count, value), insert(index, first, last) и insert(index, {...})
+ *  срещу std::vector::insert за всеки път на insert_range: растеж (realloc за int,
+ *  нов буфер за останалите), изместване на място, когато опашката е по-дълга от
+ *  вмъкнатото и когато е по-къса, както и вмъкване в началото и в края. За Tracked
+ *  след проверката не бива да остане нито един жив екземпляр.
+ */
+template<typename T>
+bool verify_insert()
+{
+    struct Case { int size, spare, index, count; };
+    const Case cases[] = {
+        {8, 0, 3, 4},       // растеж
+        {8, 0, 8, 5},       // растеж, вмъкване в края
+        {8, 8, 2, 3},       // на място, опашката (6) е по-дълга
+        {8, 8, 6, 4},       // на място, опашката (2) е по-къса
+        {8, 8, 5, 3},       // на място, опашката е равна на вмъкнатото
+        {8, 8, 0, 8},       // на място, в началото
+        {0, 0, 0, 3},       // празен вектор
+    };
+
+    bool ok = true;
+    for (const Case& c : cases)
+    {
+        std::vector<T> source;
+        for (int i = 0; i < c.count; ++i)
+        {
+            source.push_back(make_value<T>(100 + i));
+        }
+        std::vector<T> expected;
+
+        Vector<T> repeated = make_filled<T>(c.size, c.spare, expected);
+        repeated.insert(c.index, c.count, source[0]);
+        expected.insert(expected.begin() + c.index, c.count, source[0]);
+        ok = ok && same_elements(repeated, expected);
+
+        Vector<T> ranged = make_filled<T>(c.size, c.spare, expected);
+        ranged.insert(c.index, source.begin(), source.end());
+        expected.insert(expected.begin() + c.index, source.begin(), source.end());
+        ok = ok && same_elements(ranged, expected);
+
+        Vector<T> listed = make_filled<T>(c.size, c.spare, expected);
+        listed.insert(c.index, {source[0], source[c.count - 1], source[0]});
+        expected.insert(expected.begin() + c.index, {source[0], source[c.count - 1], source[0]});
+        ok = ok && same_elements(listed, expected);
+    }
+    ok = ok && Tracked::live == 0;
+
+    if (!ok)
+    {
+        std::cerr << "insert check failed: " << type_name<T>() << "\n";
+    }
+    return ok;
+}
+
+/**
+ *  erase(first, last), swap_erase, remove, remove_if и erase/erase_if срещу std::vector:
+ *  празен интервал, начало, среда, край и целия вектор, както и последния елемент
+ *  при swap_erase. Броят на изтритите елементи трябва да съвпада с модела, а за
+ *  Tracked след проверката не бива да остане нито един жив екземпляр.
+ */
+template<typename T>
+bool verify_erase()
+{
+    struct Range { int first, last; };
+    const Range ranges[] = {{4, 4}, {0, 3}, {2, 6}, {7, 10}, {0, 10}};
+
+    bool ok = true;
+    {
+        std::vector<T> expected;
+        for (const Range& r : ranges)
+        {
+            Vector<T> vec = make_filled<T>(10, 0, expected);
+            vec.erase(r.first, r.last);
+            expected.erase(expected.begin() + r.first, expected.begin() + r.last);
+            ok = ok && same_elements(vec, expected);
+        }
+
+        Vector<T> swapped = make_filled<T>(10, 0, expected);
+        for (int index : {3, 0, 7, 6})                  // 7 и 6 са последните елементи в момента на триенето
+        {
+            swapped.swap_erase(index);
+            expected[index] = expected.back();
+            expected.pop_back();
+            ok = ok && same_elements(swapped, expected);
+        }
+
+        auto make_repeating = [&expected]()
+        {
+            Vector<T> vec;
+            expected.clear();
+            for (int i = 0; i < 12; ++i)
+            {
+                vec.push_back(make_value<T>(i % 3));
+                expected.push_back(make_value<T>(i % 3));
+            }
+            return vec;
+        };
+        auto model_erase_if = [&expected](auto pred)
+        {
+            auto new_end = std::remove_if(expected.begin(), expected.end(), pred);
+            size_t removed = expected.end() - new_end;
+            expected.erase(new_end, expected.end());
+            return removed;
+        };
+        const T zero = make_value<T>(0), one = make_value<T>(1), missing = make_value<T>(5);
+        auto is_zero = [&zero](const T& value) { return value == zero; };
+        auto is_one = [&one](const T& value) { return value == one; };
+        auto any = [](const T&) { return true; };
+
+        Vector<T> removed = make_repeating();
+        ok = ok && removed.remove(missing) == 0 && same_elements(removed, expected);
+        ok = ok && removed.remove(zero) == model_erase_if(is_zero) && same_elements(removed, expected);
+        ok = ok && erase(removed, one) == model_erase_if(is_one) && same_elements(removed, expected);
+        ok = ok && removed.remove_if(any) == model_erase_if(any) && removed.empty();
+
+        Vector<T> filtered = make_repeating();
+        ok = ok && filtered.remove_if(is_one) == model_erase_if(is_one) && same_elements(filtered, expected);
+        ok = ok && erase_if(filtered, is_zero) == model_erase_if(is_zero) && same_elements(filtered, expected);
+        ok = ok && erase_if(filtered, any) == model_erase_if(any) && filtered.empty() &&
+             erase_if(filtered, any) == 0;
+    }
+    ok = ok && Tracked::live == 0;
+
+    if (!ok)
+    {
+        std::cerr << "erase check failed: " << type_name<T>() << "\n";
+    }
+    return ok;
+}
+
+/**
+ *  Таблица, построена по време на компилация: за тривиални типове всички
+ *  операции на StaticVector са constexpr.
+ */
+constexpr StaticVector<int, 8> make_static_table()
+{
+    StaticVector<int, 8> table;
+    for (int i = 0; i < 6; ++i)
+    {
+        table.push_back(i * i);         // 0 1 4 9 16 25
+    }
+    table.insert(1, 2, -1);             // 0 -1 -1 1 4 9 16 25
+    table.erase(0);                     // -1 -1 1 4 9 16 25
+    table.swap_erase(0);                // 25 -1 1 4 9 16
+    table.emplace(2, 7);                // 25 -1 7 1 4 9 16
+    table.pop_back();                   // 25 -1 7 1 4 9
+    return table;
+}
+
+constexpr StaticVector<int, 8> static_table = make_static_table();
+static_assert(static_table.size() == 6 && static_table[0] == 25 && static_table[1] == -1 &&
+              static_table[2] == 7 && static_table.back() == 9 && !static_table.full(),
+              "StaticVector must be usable in constant expressions");
+
+/**
+ *  StaticVector с нетривиални елементи: вмъкване и триене с изместване, копиране,
+ *  преместване, и std::length_error при препълване в режим Checked, след който
+ *  векторът остава непроменен.
+ */
+bool verify_static_vector()
+{
+    using Checked = StaticVector<Tracked, 6, true>;
+    bool ok = true;
+    {
+        Checked vec;
+        for (int i = 0; i < 4; ++i)
+        {
+            vec.push_back(Tracked(i));
+        }
+        vec.insert(1, 2, Tracked(9));
+        ok = ok && vec.full() && holds(vec, {0, 9, 9, 1, 2, 3});
+
+        auto overflows = [](auto&& action)
+        {
+            try
+            {
+                action();
+            }
+            catch (const std::length_error&)
+            {
+                return true;
+            }
+            return false;
+        };
+        ok = ok && overflows([&]() { vec.push_back(Tracked(7)); }) &&
+             overflows([&]() { vec.emplace(0, 7); }) &&
+             overflows([&]() { vec.insert(6, 1, Tracked(7)); }) &&
+             overflows([&]() { vec.resize(7); }) &&
+             overflows([]() { Checked too_many(7); }) &&
+             overflows([]() { Checked too_many{1, 2, 3, 4, 5, 6, 7}; }) &&
+             holds(vec, {0, 9, 9, 1, 2, 3});
+
+        vec.erase(1, 3);
+        vec.emplace(0, -1);
+        vec.swap_erase(1);
+        ok = ok && holds(vec, {-1, 3, 1, 2});
+
+        Checked copy(vec);
+        Checked moved(std::move(copy));
+        copy = moved;
+        moved.resize(2);
+        vec = std::move(moved);
+        ok = ok && holds(copy, {-1, 3, 1, 2}) && holds(vec, {-1, 3});
+
+        StaticVector<Tracked, 3> unchecked(3, Tracked(5));
+        unchecked.pop_back();
+        unchecked.insert(0, Tracked(4));
+        ok = ok && unchecked.full() && holds(unchecked, {4, 5, 5});
+    }
+    ok = ok && Tracked::live == 0;
+
+    if (!ok)
+    {
+        std::cerr << "StaticVector check failed\n";
+    }
+    return ok;
+}
+
+/**
+ *  Разпространяване на алокаторите при копиране, преместване и размяна:
+ *  - ArenaAllocator не се разпространява при копиращо присвояване, а при
+ *    преместване и размяна се разпространява заедно с буфера;
+ *  - std::pmr::polymorphic_allocator (PmrVector) не се разпространява никога:
+ *    копието взима ресурса по подразбиране, преместването между различни
+ *    ресурси мести елементите един по един, а размяната изисква равни ресурси.
+ */
+bool verify_allocators()
+{
+    bool ok = true;
+
+    MonotonicArena first_arena(1024), second_arena(1024);
+    {
+        using ArenaVector = Vector<int, ArenaAllocator<int> >;
+        ArenaVector a{ArenaAllocator<int>(first_arena)}, b{ArenaAllocator<int>(second_arena)};
+        for (int i = 0; i < 1000; ++i)
+        {
+            a.push_back(i);
+        }
+        size_t first_bytes = first_arena.bytes_allocated();
+        ok = ok && first_bytes >= 1000 * sizeof(int) && second_arena.bytes_allocated() == 0;
+
+        ArenaVector copy(a);
+        ok = ok && copy.get_allocator().arena() == &first_arena && copy.size() == 1000 && copy[999] == 999;
+
+        b = a;                                          // POCCA: false
+        ok = ok && b.get_allocator().arena() == &second_arena && b.size() == 1000 &&
+             second_arena.bytes_allocated() >= 1000 * sizeof(int);
+
+        const int* stolen = copy.data();
+        b = std::move(copy);                            // POCMA: true
+        ok = ok && b.get_allocator().arena() == &first_arena && b.data() == stolen && copy.empty();
+
+        ArenaVector c{ArenaAllocator<int>(second_arena)};
+        c.push_back(-1);
+        const int* a_data = a.data();
+        const int* c_data = c.data();
+        swap(a, c);                                     // POCS: true
+        ok = ok && a.get_allocator().arena() == &second_arena && a.data() == c_data && a.size() == 1 &&
+             c.get_allocator().arena() == &first_arena && c.data() == a_data && c.size() == 1000;
+
+        Vector<double, ArenaAllocator<double> > large(3000, 1.5, ArenaAllocator<double>(first_arena));   // по-голям от блок на арената
+        ok = ok && reinterpret_cast<std::uintptr_t>(large.data()) % alignof(double) == 0 && large[2999] == 1.5;
+    }
+    first_arena.release();
+    ok = ok && first_arena.bytes_allocated() == 0;
+
+    {
+        PmrVector<std::string> a{&first_arena}, b{&second_arena};
+        for (int i = 0; i < 100; ++i)
+        {
+            a.push_back(make_value<std::string>(i));
+        }
+
+        PmrVector<std::string> copy(a);
+        ok = ok && copy.get_allocator().resource() == std::pmr::get_default_resource() && copy.size() == 100;
+
+        b = a;                                          // POCCA: false
+        ok = ok && b.get_allocator().resource() == &second_arena && b.size() == 100 && b[99] == a[99];
+
+        b = std::move(copy);                            // различни ресурси: поелементно
+        ok = ok && b.get_allocator().resource() == &second_arena && b.size() == 100 && copy.empty() &&
+             b[0] == make_value<std::string>(0);
+
+        PmrVector<std::string> same{&first_arena};
+        same.push_back("same");
+        const std::string* a_data = a.data();
+        same = std::move(a);                            // равни ресурси: буферът се открадва
+        ok = ok && same.data() == a_data && same.size() == 100 && a.empty();
+
+        a.push_back("swapped");
+        swap(a, same);                                  // POCS: false, ресурсите са равни
+        ok = ok && a.data() == a_data && a.size() == 100 && same.size() == 1 && same[0] == "swapped" &&
+             a.get_allocator().resource() == &first_arena && same.get_allocator().resource() == &first_arena;
+    }
+
+    if (!ok)
+    {
+        std::cerr << "allocator propagation check failed\n";
+    }
+    return ok;
+}
+
+/**
+ *  Дали парчетата на vec, обходени с for_each_chunk, дават точно елементите на
+ *  expected в същия ред, като всички парчета освен последното са пълни.
+ */
+template<typename C, typename T>
+bool same_chunks(const C& vec, const std::vector<T>& expected)
+{
+    size_t index = 0, chunks = 0;
+    bool ok = true;
+    vec.for_each_chunk([&](const T* begin, const T* end)
+    {
+        ok = ok && (end - begin == static_cast<std::ptrdiff_t>(C::chunk_size) ||
+                    index + (end - begin) == expected.size());
+        for (const T* it = begin; ok && it != end; ++it)
+        {
+            ok = index < expected.size() && *it == expected[index++];
+        }
+        ++chunks;
+    });
+    return ok && index == expected.size() && chunks == (expected.size() + C::chunk_size - 1) / C::chunk_size;
+}
+
+/**
+ *  SegmentedVector с парчета от по 4 елемента срещу std::vector: вмъкване и триене
+ *  през границите на парчетата, освобождаване на празните парчета (с едно резервно
+ *  след триене и без него след shrink_to_fit), редът на for_each_chunk, както и
+ *  копиране, преместване и размяна с ArenaAllocator и с pmr ресурси. Накрая не
+ *  бива да остане нито един жив Tracked.
+ */
+bool verify_segmented_vector()
+{
+    bool ok = true;
+    {
+        using Segmented = SegmentedVector<Tracked, std::allocator<Tracked>, 2>;
+        Segmented vec;
+        std::vector<Tracked> expected;
+        for (int i = 0; i < 10; ++i)
+        {
+            vec.push_back(Tracked(i));
+            expected.push_back(Tracked(i));
+        }
+        ok = ok && vec.chunk_count() == 3 && vec.capacity() == 12 && same_chunks(vec, expected);
+
+        vec.insert(3, 5, Tracked(-1));
+        expected.insert(expected.begin() + 3, 5, Tracked(-1));
+        ok = ok && same_elements(vec, expected);
+
+        const std::vector<Tracked> source{Tracked(20), Tracked(21), Tracked(22), Tracked(23), Tracked(24), Tracked(25)};
+        vec.insert(6, source.begin(), source.end());
+        expected.insert(expected.begin() + 6, source.begin(), source.end());
+        vec.insert(1, {Tracked(30), Tracked(31)});
+        expected.insert(expected.begin() + 1, {Tracked(30), Tracked(31)});
+        vec.emplace(4, 40);
+        expected.insert(expected.begin() + 4, Tracked(40));
+        ok = ok && vec.size() == 24 && vec.chunk_count() == 6 && same_chunks(vec, expected);
+
+        vec.erase(2, 19);                               // 17 елемента от парче 0 до парче 4
+        expected.erase(expected.begin() + 2, expected.begin() + 19);
+        ok = ok && same_chunks(vec, expected) && vec.chunk_count() == 3;          // 7 елемента и едно резервно
+
+        vec.swap_erase(1);
+        expected[1] = expected.back();
+        expected.pop_back();
+        vec.remove_if([](const Tracked& t) { return t.m_value % 2 == 0; });
+        expected.erase(std::remove_if(expected.begin(), expected.end(),
+                                      [](const Tracked& t) { return t.m_value % 2 == 0; }), expected.end());
+        ok = ok && same_chunks(vec, expected);
+
+        vec.shrink_to_fit();
+        ok = ok && vec.chunk_count() == static_cast<int>((expected.size() + 3) / 4) && same_chunks(vec, expected);
+
+        Segmented copy(vec);
+        Segmented moved(std::move(copy));
+        copy = moved;
+        moved.clear();
+        moved.shrink_to_fit();
+        ok = ok && same_chunks(copy, expected) && moved.empty() && moved.chunk_count() == 0 &&
+             Tracked::live == static_cast<int>(vec.size() + copy.size() + expected.size() + source.size());
+    }
+    ok = ok && Tracked::live == 0;
+
+    MonotonicArena first_arena(1024), second_arena(1024);
+    {
+        using ArenaSegmented = SegmentedVector<int, ArenaAllocator<int>, 4>;
+        ArenaSegmented a{ArenaAllocator<int>(first_arena)}, b{ArenaAllocator<int>(second_arena)};
+        for (int i = 0; i < 100; ++i)
+        {
+            a.push_back(i);
+        }
+        ok = ok && first_arena.bytes_allocated() >= 100 * sizeof(int) && second_arena.bytes_allocated() == 0;
+
+        ArenaSegmented copy(a);
+        ok = ok && copy.get_allocator().arena() == &first_arena && copy.size() == 100 && copy[99] == 99;
+
+        b = a;                                          // POCCA: false
+        ok = ok && b.get_allocator().arena() == &second_arena && b.size() == 100 && b[50] == 50 &&
+             second_arena.bytes_allocated() >= 100 * sizeof(int);
+
+        const int* stolen = &copy[0];
+        b = std::move(copy);                            // POCMA: true, парчетата се открадват
+        ok = ok && b.get_allocator().arena() == &first_arena && &b[0] == stolen && copy.empty();
+
+        ArenaSegmented c{ArenaAllocator<int>(second_arena)};
+        c.push_back(-1);
+        const int* a_first = &a[0];
+        swap(a, c);                                     // POCS: true
+        ok = ok && a.get_allocator().arena() == &second_arena && a.size() == 1 && a[0] == -1 &&
+             c.get_allocator().arena() == &first_arena && &c[0] == a_first && c.size() == 100;
+    }
+
+    {
+        using PmrSegmented = SegmentedVector<std::string, std::pmr::polymorphic_allocator<std::string>, 2>;
+        PmrSegmented a{&first_arena}, b{&second_arena};
+        std::vector<std::string> expected;
+        for (int i = 0; i < 30; ++i)
+        {
+            a.push_back(make_value<std::string>(i));
+            expected.push_back(make_value<std::string>(i));
+        }
+
+        PmrSegmented copy(a);
+        ok = ok && copy.get_allocator().resource() == std::pmr::get_default_resource() && same_chunks(copy, expected);
+
+        b = a;                                          // POCCA: false
+        ok = ok && b.get_allocator().resource() == &second_arena && same_chunks(b, expected);
+
+        b = std::move(copy);                            // различни ресурси: поелементно
+        ok = ok && b.get_allocator().resource() == &second_arena && same_chunks(b, expected) && copy.empty();
+
+        PmrSegmented same{&first_arena};
+        const std::string* a_first = &a[0];
+        same = std::move(a);                            // равни ресурси: парчетата се открадват
+        ok = ok && &same[0] == a_first && same_chunks(same, expected) && a.empty();
+
+        a.push_back("swapped");
+        swap(a, same);                                  // POCS: false, ресурсите са равни
+        ok = ok && &a[0] == a_first && same_chunks(a, expected) && same.size() == 1 && same[0] == "swapped";
+    }
+
+    if (!ok)
+    {
+        std::cerr << "SegmentedVector check failed\n";
+    }
+    return ok;
+}
+
+/**
+ *  Капацитетите, през които минава вектор с политика G, докато в него се добавят
+ *  n елемента един по един.
+ */
+template<typename G>
+std::vector<size_t> capacity_sequence(size_t n)
+{
+    Vector<int, std::allocator<int>, G> vec;
+    std::vector<size_t> capacities;
+    for (size_t i = 0; i < n; ++i)
+    {
+        vec.push_back(static_cast<int>(i));
+        if (capacities.empty() || capacities.back() != static_cast<size_t>(vec.capacity()))
+        {
+            capacities.push_back(static_cast<size_t>(vec.capacity()));
+        }
+    }
+    return capacities;
+}
+
+/**
+ *  Капацитет след shrink_to_fit на вектор с политика G, капацитет capacity и size елемента.
+ */
+template<typename G>
+int shrunk_capacity(size_t capacity, size_t size)
+{
+    Vector<int, std::allocator<int>, G> vec;
+    vec.reserve(capacity);
+    vec.resize(size);
+    vec.shrink_to_fit();
+    return vec.capacity();
+}
+
+/**
+ *  Политики на растеж: капацитетите на SizeClassGrowth са точно класове на
+ *  алокатора, тези на PageGrowth над прага са цели страници, а shrink_to_fit
+ *  смалява едва когато свободното място надхвърли една стъпка на растеж.
+ */
+bool verify_growth()
+{
+    bool ok = round_to_size_class(1) == 8 && round_to_size_class(9) == 16 && round_to_size_class(128) == 128 &&
+              round_to_size_class(129) == 160 && round_to_size_class(257) == 320 &&
+              round_to_size_class(1025) == 1280 && round_to_size_class(4096) == 4096;
+
+    const size_t n = 1000000;
+    std::vector<size_t> size_classes = capacity_sequence<SizeClassGrowth<> >(n);
+    std::vector<size_t> pages = capacity_sequence<PageGrowth<> >(n);
+    std::vector<size_t> geometric = capacity_sequence<GeometricGrowth<> >(n);
+    for (size_t i = 0; i < size_classes.size(); ++i)
+    {
+        size_t bytes = size_classes[i] * sizeof(int);
+        ok = ok && bytes == round_to_size_class(bytes) && (i == 0 || size_classes[i] * 2 >= size_classes[i - 1] * 3);
+    }
+    for (size_t i = 0; i < pages.size(); ++i)
+    {
+        size_t bytes = pages[i] * sizeof(int);
+        ok = ok && (bytes < 64 * 1024 ? i < geometric.size() && pages[i] == geometric[i] : bytes % 4096 == 0);
+    }
+    ok = ok && size_classes.back() >= n && pages.back() >= n && pages.back() * sizeof(int) >= 64 * 1024;
+
+    // Смаляване има само ако капацитетът надхвърля стъпка на растеж от (закръгления) размер.
+    // GeometricGrowth: 67 * 1.5 > 100, но 66 * 1.5 < 100.
+    ok = ok && shrunk_capacity<GeometricGrowth<> >(100, 67) == 100 &&
+         shrunk_capacity<GeometricGrowth<> >(100, 66) == 66 &&
+         shrunk_capacity<GeometricGrowth<> >(100, 0) == 0;
+    // SizeClassGrowth: 700 int-а са в класа от 3072 байта (768 * 1.5 > 1000), 600 - в класа от 2560 (640 * 1.5 < 1000).
+    ok = ok && shrunk_capacity<SizeClassGrowth<> >(1000, 700) == 1000 &&
+         shrunk_capacity<SizeClassGrowth<> >(1000, 600) == 640 &&
+         shrunk_capacity<SizeClassGrowth<> >(1000, 10) == 12;
+    // PageGrowth: 70000 int-а заемат 69 страници (70656 * 1.5 > 100000), 60000 - 59 страници (60416 * 1.5 < 100000).
+    ok = ok && shrunk_capacity<PageGrowth<> >(100000, 70000) == 100000 &&
+         shrunk_capacity<PageGrowth<> >(100000, 60000) == 60416 &&
+         shrunk_capacity<PageGrowth<> >(100000, 1000) == 1000;
+
+    if (!ok)
+    {
+        std::cerr << "growth policy check failed\n";
+    }
+    return ok;
+}
+
+#ifdef VECTOR_ENABLE_STATS
+/**
+ *  Броячите на един вектор и сборните за типа T при добавяне, триене и унищожаване.
+ *  За int буферът расте с realloc, за std::string - с нов буфер от алокатора.
+ *  Неуспешно заделяне (bad_alloc) не бива да променя нито един брояч.
+ */
+template<typename T>
+bool verify_type_stats()
+{
+    VectorTypeStats& type_stats = vector_type_stats<T>();
+    const VectorStats before = type_stats.snapshot();
+    const size_t instances = type_stats.instances.load();
+    bool ok = true;
+    {
+        Vector<T> vec;
+        size_t buffers = 0;
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            int capacity = vec.capacity();
+            vec.push_back(make_value<T>(i));
+            buffers += vec.capacity() != capacity;
+        }
+        vec.erase(0, 500);
+
+        const VectorStats stats = vec.stats();
+        const VectorStats live = type_stats.snapshot();
+        ok = stats.allocations == buffers && stats.deallocations == buffers - 1 && stats.reallocations == buffers - 1 &&
+             stats.constructions == 1000 && stats.destructions == 500 && stats.peak_size == 1000 &&
+             stats.peak_capacity == static_cast<size_t>(vec.capacity()) &&
+             live.allocations - before.allocations == buffers && live.deallocations - before.deallocations == buffers - 1;
+
+        bool thrown = false;
+        try
+        {
+            vec.reserve(size_t(1) << 60);
+        }
+        catch (const std::bad_alloc&)
+        {
+            thrown = true;
+        }
+        const VectorStats failed = type_stats.snapshot();
+        ok = ok && thrown && vec.size() == 500 && vec.stats().allocations == buffers &&
+             failed.allocations == live.allocations && failed.deallocations == live.deallocations &&
+             failed.bytes_allocated == live.bytes_allocated;
+    }
+    const VectorStats after = type_stats.snapshot();
+    ok = ok && after.allocations - before.allocations == after.deallocations - before.deallocations &&
+         after.constructions - before.constructions == 1000 && after.destructions - before.destructions == 1000 &&
+         type_stats.instances.load() == instances + 1;
+
+    if (!ok)
+    {
+        std::cerr << "stats check failed: " << type_name<T>() << "\n";
+    }
+    return ok;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = parse_options(argc, argv);
+
+    bool ok = verify_small_vector();
+    ok = verify_emplace() && ok;
+    ok = verify_insert<int>() && ok;
+    ok = verify_insert<std::string>() && ok;
+    ok = verify_insert<Tracked>() && ok;
+    ok = verify_erase<int>() && ok;
+    ok = verify_erase<std::string>() && ok;
+    ok = verify_erase<Tracked>() && ok;
+    ok = verify_static_vector() && ok;
+    ok = verify_allocators() && ok;
+    ok = verify_segmented_vector() && ok;
+    ok = verify_growth() && ok;
+#ifdef VECTOR_ENABLE_STATS
+    ok = verify_type_stats<int>() && ok;
+    ok = verify_type_stats<std::string>() && ok;
+#endif
+    if (!ok)
+    {
+        return 1;
+    }
+    std::cerr << "verified SmallVector, emplace, insert, erase, StaticVector, allocator propagation, SegmentedVector and growth policies\n";
+#ifdef VECTOR_ENABLE_STATS
+    std::cerr << "verified Vector statistics\n";
+#endif
+
+    std::vector<Measurement> results;
+    run_type<int>(options, results);
+    run_type<std::string>(options, results);
+    run_type<Student>(options, results);
+
+    report(results, options.format, std::cout);
+    return 0;
+}
@@ -0,0 +1,180 @@
+#ifndef ALIGNEDALLOCATOR_H
+#define ALIGNEDALLOCATOR_H
+
+#include "Vector.h"
+#include "VectorTraits.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <sys/mman.h>
+
+/**
+ *  Как AlignedAllocator заделя големите буфери (поне HUGE_PAGE_SIZE байта):
+ *  - none        - като малките, чрез подравнения operator new;
+ *  - transparent - mmap, подравнен на 2 MB, с madvise(MADV_HUGEPAGE), така че ядрото
+ *                  да го покрие с прозрачни големи страници (THP);
+ *  - hugetlb     - първо mmap с MAP_HUGETLB (изисква предварително заделени големи
+ *                  страници, vm.nr_hugepages); ако няма свободни, както при transparent.
+ */
+enum class HugePageMode
+{
+    none,
+    transparent,
+    hugetlb
+};
+
+/**
+ *  Алокатор без състояние, който гарантира подравняване на паметта поне на Alignment
+ *  байта (по подразбиране 64 - един кеш ред и един регистър на AVX-512), така че
+ *  векторизираните цикли не чупят зареждания през границата на кеш ред.
+ *  Големите буфери се заделят директно чрез mmap според Huge (виж HugePageMode): с
+ *  големи страници един запис в TLB покрива 2 MB вместо 4 KB и обхождането на
+ *  многогигабайтови вектори почти не губи време в TLB пропуски.
+ *
+ *  Vector с този алокатор (AlignedVector) не расте чрез realloc, защото паметта не е от
+ *  malloc; за сметка на това при големите буфери старите страници се връщат веднага.
+ *
+ *      AlignedVector<float> samples;                                   // 64 байта, THP
+ *      Vector<float, AlignedAllocator<float, 128, HugePageMode::hugetlb> > buffer;
+ */
+template<typename T, size_t Alignment = 64, HugePageMode Huge = HugePageMode::transparent>
+class AlignedAllocator
+{
+public:
+    static_assert(Alignment && !(Alignment & (Alignment - 1)), "AlignedAllocator: alignment must be a power of two");
+
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;   // размер на голяма страница на x86-64 и повечето ARM64
+    static constexpr size_t ALIGNMENT = Alignment > alignof(T) ? Alignment : alignof(T);
+
+    static_assert(ALIGNMENT <= HUGE_PAGE_SIZE, "AlignedAllocator: alignment must not exceed the huge page size");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment, Huge>;
+    };
+
+    AlignedAllocator() noexcept {}
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment, Huge>&) noexcept {}
+
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n) noexcept;
+
+private:
+    static bool mapped(size_t bytes)    { return Huge != HugePageMode::none && bytes >= HUGE_PAGE_SIZE; }
+    static size_t mapped_length(size_t bytes) { return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1); }
+    static void* map_huge(size_t length);
+};
+
+/**
+ *  Заделя памет за n елемента, подравнена на ALIGNMENT байта (големите буфери - на 2 MB).
+ *  При липса на памет хвърля std::bad_alloc.
+ */
+template<typename T, size_t Alignment, HugePageMode Huge>
+T* AlignedAllocator<T, Alignment, Huge>::allocate(size_t n)
+{
+    if (n > static_cast<size_t>(-1) / sizeof(T))
+    {
+        throw std::bad_array_new_length();
+    }
+
+    size_t bytes = n * sizeof(T);
+    if (mapped(bytes))
+    {
+        return static_cast<T*>(map_huge(mapped_length(bytes)));
+    }
+    return static_cast<T*>(::operator new(bytes, std::align_val_t(ALIGNMENT)));
+}
+
+/**
+ *  Освобождава паметта по начина, по който е била заделена: размерът n е същият
+ *  като при allocate, затова еднозначно определя дали буферът е от mmap.
+ */
+template<typename T, size_t Alignment, HugePageMode Huge>
+void AlignedAllocator<T, Alignment, Huge>::deallocate(T* p, size_t n) noexcept
+{
+    size_t bytes = n * sizeof(T);
+    if (mapped(bytes))
+    {
+        ::munmap(p, mapped_length(bytes));
+    }
+    else
+    {
+        ::operator delete(p, std::align_val_t(ALIGNMENT));
+    }
+}
+
+/**
+ *  Изобразява length байта (кратно на HUGE_PAGE_SIZE) анонимна памет, подравнена на
+ *  HUGE_PAGE_SIZE. При hugetlb първо се опитва с MAP_HUGETLB. Иначе се изобразява
+ *  една голяма страница повече, излишъкът в двата края се връща веднага, а за
+ *  останалото ядрото се съветва да ползва прозрачни големи страници.
+ */
+template<typename T, size_t Alignment, HugePageMode Huge>
+void* AlignedAllocator<T, Alignment, Huge>::map_huge(size_t length)
+{
+#ifdef MAP_HUGETLB
+    if (Huge == HugePageMode::hugetlb)
+    {
+        void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            return p;
+        }
+    }
+#endif
+
+    void* raw = ::mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+
+    char* begin = static_cast<char*>(raw);
+    char* aligned = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(begin) + HUGE_PAGE_SIZE - 1) &
+                                            ~static_cast<std::uintptr_t>(HUGE_PAGE_SIZE - 1));
+    if (aligned != begin)
+    {
+        ::munmap(begin, aligned - begin);
+    }
+    if (aligned + length != begin + length + HUGE_PAGE_SIZE)
+    {
+        ::munmap(aligned + length, begin + HUGE_PAGE_SIZE - aligned);
+    }
+
+#ifdef MADV_HUGEPAGE
+    ::madvise(aligned, length, MADV_HUGEPAGE);     // само съвет: ако THP е изключено, паметта остава с малки страници
+#endif
+    return aligned;
+}
+
+template<typename T, typename U, size_t Alignment, HugePageMode Huge>
+bool operator==(const AlignedAllocator<T, Alignment, Huge>&, const AlignedAllocator<U, Alignment, Huge>&) noexcept
+{
+    return true;
+}
+
+template<typename T, typename U, size_t Alignment, HugePageMode Huge>
+bool operator!=(const AlignedAllocator<T, Alignment, Huge>& a, const AlignedAllocator<U, Alignment, Huge>& b) noexcept
+{
+    return !(a == b);
+}
+
+template<typename T, size_t Alignment, HugePageMode Huge>
+struct is_plain_allocator<AlignedAllocator<T, Alignment, Huge> > : std::true_type {};
+
+/**
+ *  Вектор, чиито елементи започват от адрес, подравнен на Alignment байта, а големите
+ *  буфери са в прозрачни големи страници.
+ */
+template<typename T, size_t Alignment = 64>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment> >;
+
+#endif // ALIGNEDALLOCATOR_H
@@ -0,0 +1,150 @@
+#ifndef ARENAALLOCATOR_H
+#define ARENAALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+
+/**
+ *  Монотонна арена: паметта се заделя чрез последователно "отрязване" от големи
+ *  блокове (bump pointer), а отделните освобождавания се игнорират. Цялата памет
+ *  се освобождава наведнъж чрез release() или в деструктора.
+ *  Арената е std::pmr::memory_resource, така че може да се ползва както чрез
+ *  ArenaAllocator, така и чрез std::pmr::polymorphic_allocator (PmrVector).
+ */
+class MonotonicArena : public std::pmr::memory_resource
+{
+public:
+    static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;     // размер на блок по подразбиране в байтове
+
+    explicit MonotonicArena(size_t block_size = DEFAULT_BLOCK_SIZE,
+                            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : m_upstream(upstream), m_blocks(nullptr), m_current(nullptr), m_end(nullptr),
+          m_block_size(block_size), m_bytes_allocated(0) {}
+
+    MonotonicArena(const MonotonicArena& other) = delete;               // арената притежава паметта си
+    MonotonicArena& operator=(const MonotonicArena& other) = delete;
+
+    ~MonotonicArena()                   { release(); }
+
+    void release();
+    size_t bytes_allocated() const      { return m_bytes_allocated; }   // общо заделени байтове от потребителите на арената
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}              // паметта се освобождава наведнъж в release()
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    /**
+     *  Заглавие на блок, заделен от upstream ресурса. Блоковете образуват
+     *  едносвързан списък, за да могат да бъдат освободени в release().
+     */
+    struct Block
+    {
+        Block* next;
+        size_t size;        // размер на целия блок заедно със заглавието
+    };
+
+    std::pmr::memory_resource* m_upstream;  // откъдето арената взима блоковете си
+    Block* m_blocks;                        // последно заделеният блок
+    char* m_current;                        // начало на свободната част от текущия блок
+    char* m_end;                            // край на текущия блок
+    size_t m_block_size;
+    size_t m_bytes_allocated;
+};
+
+/**
+ *  Отрязва bytes байта с подравняване alignment от текущия блок. Ако не стигат,
+ *  се заделя нов блок, достатъчно голям и за заявки, по-големи от m_block_size.
+ */
+inline void* MonotonicArena::do_allocate(size_t bytes, size_t alignment)
+{
+    void* p = m_current;
+    size_t free_space = m_end - m_current;
+
+    if (!m_current || !std::align(alignment, bytes, p, free_space))
+    {
+        size_t block_size = sizeof(Block) + alignment + bytes;
+        if (block_size < m_block_size)
+        {
+            block_size = m_block_size;
+        }
+
+        Block* block = static_cast<Block*>(m_upstream->allocate(block_size, alignof(std::max_align_t)));
+        block->next = m_blocks;
+        block->size = block_size;
+        m_blocks = block;
+        m_current = reinterpret_cast<char*>(block + 1);
+        m_end = reinterpret_cast<char*>(block) + block_size;
+
+        p = m_current;
+        free_space = m_end - m_current;
+        std::align(alignment, bytes, p, free_space);
+    }
+
+    m_current = static_cast<char*>(p) + bytes;
+    m_bytes_allocated += bytes;
+    return p;
+}
+
+/**
+ *  Връща всички блокове на upstream ресурса. Указателите, получени от арената,
+ *  стават невалидни, затова контейнерите, които я ползват, трябва да са унищожени.
+ */
+inline void MonotonicArena::release()
+{
+    while (m_blocks)
+    {
+        Block* next = m_blocks->next;
+        m_upstream->deallocate(m_blocks, m_blocks->size, alignof(std::max_align_t));
+        m_blocks = next;
+    }
+
+    m_current = m_end = nullptr;
+    m_bytes_allocated = 0;
+}
+
+/**
+ *  Алокатор със състояние, който взима паметта си от MonotonicArena.
+ *  deallocate не прави нищо, паметта се връща наведнъж чрез арената.
+ *  Алокаторът се разпространява при преместване и размяна (евтино кражба на буфера),
+ *  но не и при копиране, за да не може копие в дълго живеещ вектор да остане
+ *  свързано с арена, която ще бъде освободена.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit ArenaAllocator(MonotonicArena& arena) noexcept : m_arena(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_arena(other.arena()) {}
+
+    T* allocate(size_t n)               { return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) noexcept {}
+    MonotonicArena* arena() const noexcept { return m_arena; }
+
+private:
+    MonotonicArena* m_arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept
+{
+    return a.arena() == b.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept
+{
+    return !(a == b);
+}
+
+#endif // ARENAALLOCATOR_H
@@ -0,0 +1,324 @@
+#ifndef CONCURRENTVECTOR_H
+#define CONCURRENTVECTOR_H
+
+#include "VectorStats.h"
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ *  Вектор само за добавяне, в който няколко нишки могат едновременно да добавят
+ *  елементи (push_back, emplace_back, grow_by) без заключване, а други нишки да четат
+ *  вече добавените елементи по индекс.
+ *
+ *  Елементите са в сегменти с нарастващ размер: сегмент k побира 2^(first_segment_bits + k)
+ *  елемента, така че индексът се превръща в (сегмент, отместване) с няколко побитови
+ *  операции. Сегментите не се преместват никога, затова референциите към елементите
+ *  остават валидни докато векторът съществува.
+ *
+ *  Добавянето резервира индекс с fetch_add, при нужда заделя сегмента (при състезание
+ *  печели една нишка чрез compare_exchange), конструира елемента и го отбелязва като
+ *  готов. size() е броят на готовите елементи без пропуски: всеки индекс под size()
+ *  може да се чете безопасно от всяка нишка.
+ *
+ *  Ако конструкторът на елемент (или заделянето на сегмента му) хвърли изключение,
+ *  слотът остава празен завинаги, а с него при grow_by и останалите слотове на
+ *  заявката. size() никога не минава отвъд такъв слот, затова елементите, добавени
+ *  след него, не стават видими и векторът е неизползваем до clear(). Пропуск не може
+ *  да бъде прескочен, защото тогава индекс под size() би сочил неконструиран елемент.
+ *
+ *  Т - шаблонен тип на елементите, А - шаблонен тип на алокатора
+ */
+template<typename T, typename A = std::allocator<T> >
+class ConcurrentVector
+{
+public:
+    static constexpr size_t first_segment_bits = 5;     // първият сегмент е 32 елемента
+    static constexpr size_t max_segments = sizeof(size_t) * 8 - first_segment_bits;
+
+    ConcurrentVector() : ConcurrentVector(A()) {}
+    explicit ConcurrentVector(const A& alloc);
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+    ~ConcurrentVector();
+
+    size_t size() const                 { return m_size.load(std::memory_order_acquire); }          // брой готови елементи
+    bool empty() const                  { return size() == 0; }                                     // проверява дали няма готови елементи
+    size_t capacity() const;
+    A get_allocator() const             { return m_alloc; }                                         // връща копие на алокатора
+
+    T& operator[](size_t i)             { return *slot(i); }            // достъп до i-я елемент; i трябва да е готов
+    const T& operator[](size_t i) const { return *slot(i); }
+
+    size_t push_back(const T& val)      { return emplace(val); }               // добавя копие, връща индекса му
+    size_t push_back(T&& val)           { return emplace(std::move(val)); }    // добавя преместен елемент, връща индекса му
+    template<typename... Args>
+    T& emplace_back(Args&&... args)     { return *slot(emplace(std::forward<Args>(args)...)); }
+    size_t grow_by(size_t count, const T& val = T());
+
+    void reserve(size_t new_capacity);
+    void clear();
+
+private:
+    using alloc_traits = std::allocator_traits<A>;
+    using state_type = std::atomic<unsigned char>;
+
+    // състояния на слот
+    static constexpr unsigned char slot_empty = 0;
+    static constexpr unsigned char slot_ready = 1;
+    static constexpr unsigned char slot_failed = 2;
+
+    static size_t segment_of(size_t index);
+    static size_t segment_begin(size_t segment)     { return (size_t(1) << (first_segment_bits + segment)) - (size_t(1) << first_segment_bits); }
+    static size_t segment_size(size_t segment)      { return size_t(1) << (first_segment_bits + segment); }
+    static size_t state_slots(size_t segment)       { return (segment_size(segment) * sizeof(state_type) + sizeof(T) - 1) / sizeof(T); }
+
+    T* slot(size_t index) const;
+    state_type& state(size_t index) const;
+    T* segment(size_t segment);
+    void release_segments();
+
+    template<typename... Args>
+    size_t emplace(Args&&... args);
+
+    template<typename... Args>
+    void construct_at(size_t index, Args&&... args);
+
+    void publish();
+
+    A m_alloc;
+    std::atomic<size_t> m_reserved{0};          // брой раздадени индекси
+    std::atomic<size_t> m_size{0};              // брой готови елементи без пропуски
+    std::atomic<T*> m_segments[max_segments];   // сегмент k, следван от масив със състоянията на слотовете му
+};
+
+template<typename T, typename A>
+ConcurrentVector<T, A>::ConcurrentVector(const A& alloc)
+    : m_alloc(alloc)
+{
+    for (std::atomic<T*>& segment : m_segments)
+    {
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+/**
+ *  Деструктор. Не трябва да се извиква, докато други нишки добавят или четат.
+ */
+template<typename T, typename A>
+ConcurrentVector<T, A>::~ConcurrentVector()
+{
+    clear();
+    release_segments();
+}
+
+/**
+ *  Номер на сегмента, в който е елементът с индекс index.
+ */
+template<typename T, typename A>
+size_t ConcurrentVector<T, A>::segment_of(size_t index)
+{
+    size_t adjusted = index + (size_t(1) << first_segment_bits);
+    size_t msb = sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(adjusted);
+    return msb - first_segment_bits;
+}
+
+template<typename T, typename A>
+T* ConcurrentVector<T, A>::slot(size_t index) const
+{
+    size_t k = segment_of(index);
+    return m_segments[k].load(std::memory_order_acquire) + (index - segment_begin(k));
+}
+
+template<typename T, typename A>
+typename ConcurrentVector<T, A>::state_type& ConcurrentVector<T, A>::state(size_t index) const
+{
+    size_t k = segment_of(index);
+    T* elements = m_segments[k].load(std::memory_order_acquire);
+    return reinterpret_cast<state_type*>(elements + segment_size(k))[index - segment_begin(k)];
+}
+
+/**
+ *  Връща сегмент k, като го заделя, ако още не съществува. Ако две нишки го заделят
+ *  едновременно, compare_exchange оставя единия сегмент, а другият се освобождава.
+ */
+template<typename T, typename A>
+T* ConcurrentVector<T, A>::segment(size_t k)
+{
+    T* current = m_segments[k].load(std::memory_order_acquire);
+    if (current)
+    {
+        return current;
+    }
+
+    A alloc(m_alloc);
+    size_t n = segment_size(k) + state_slots(k);
+    T* fresh = alloc_traits::allocate(alloc, n);
+    state_type* states = reinterpret_cast<state_type*>(fresh + segment_size(k));
+    for (size_t i = 0; i < segment_size(k); ++i)
+    {
+        new (states + i) state_type(slot_empty);
+    }
+
+    if (m_segments[k].compare_exchange_strong(current, fresh))
+    {
+        VECTOR_STATS_HOOK(vector_type_stats<T>().on_allocate(n * sizeof(T)));
+        return fresh;
+    }
+    alloc_traits::deallocate(alloc, fresh, n);
+    return current;
+}
+
+/**
+ *  Резервира индекс, конструира в него елемент от args и го публикува.
+ */
+template<typename T, typename A>
+template<typename... Args>
+size_t ConcurrentVector<T, A>::emplace(Args&&... args)
+{
+    size_t index = m_reserved.fetch_add(1);
+    construct_at(index, std::forward<Args>(args)...);
+    publish();
+    return index;
+}
+
+/**
+ *  Добавя count копия на val на последователни индекси.
+ *
+ *  @param  count   -   брой елементи
+ *  @param  val     -   стойност на новите елементи
+ *  @return индекс на първия добавен елемент
+ */
+template<typename T, typename A>
+size_t ConcurrentVector<T, A>::grow_by(size_t count, const T& val)
+{
+    size_t first = m_reserved.fetch_add(count);
+    for (size_t index = first; index != first + count; ++index)
+    {
+        construct_at(index, val);
+    }
+    publish();
+    return first;
+}
+
+template<typename T, typename A>
+template<typename... Args>
+void ConcurrentVector<T, A>::construct_at(size_t index, Args&&... args)
+{
+    size_t k = segment_of(index);
+    T* elements = segment(k);
+    state_type& slot_state = reinterpret_cast<state_type*>(elements + segment_size(k))[index - segment_begin(k)];
+    try
+    {
+        alloc_traits::construct(m_alloc, elements + (index - segment_begin(k)), std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        slot_state.store(slot_failed, std::memory_order_release);
+        throw;
+    }
+    slot_state.store(slot_ready);
+}
+
+/**
+ *  Придвижва size() през всички последователно готови слотове. Всяка нишка, която
+ *  е завършила елемент, помага, така че никоя не чака друга.
+ *
+ *  Резервирането на индекс, заделянето на сегмент, отбелязването на слота като готов
+ *  и четенията тук са seq_cst: ако нишка A завърши слот i, докато нишка B придвижва
+ *  size() до i, поне една от двете вижда записа на другата и продължава, така че
+ *  size() не спира пред готов слот.
+ */
+template<typename T, typename A>
+void ConcurrentVector<T, A>::publish()
+{
+    size_t current = m_size.load();
+    while (current < m_reserved.load())
+    {
+        // сегментът може още да не е заделен, ако нишката на слота не е стигнала дотам
+        if (!m_segments[segment_of(current)].load() || state(current).load() != slot_ready)
+        {
+            return;
+        }
+        // при неуспех current вече е стойността, публикувана от друга нишка
+        m_size.compare_exchange_weak(current, current + 1);
+    }
+}
+
+/**
+ *  Край на индексите, покрити от най-високия заделен сегмент. Всяка нишка заделя
+ *  сегмента на своя индекс, така че сегмент k + 1 може да бъде заделен преди k;
+ *  затова не спираме при първия незаделен сегмент.
+ */
+template<typename T, typename A>
+size_t ConcurrentVector<T, A>::capacity() const
+{
+    for (size_t k = max_segments; k-- > 0; )
+    {
+        if (m_segments[k].load(std::memory_order_acquire))
+        {
+            return segment_begin(k) + segment_size(k);
+        }
+    }
+    return 0;
+}
+
+/**
+ *  Заделя предварително сегментите, нужни за new_capacity елемента.
+ *  Може да се вика едновременно с добавянето.
+ */
+template<typename T, typename A>
+void ConcurrentVector<T, A>::reserve(size_t new_capacity)
+{
+    if (new_capacity == 0)
+    {
+        return;
+    }
+    for (size_t k = 0; k <= segment_of(new_capacity - 1); ++k)
+    {
+        segment(k);
+    }
+}
+
+/**
+ *  Унищожава всички елементи, като запазва сегментите.
+ *  Не трябва да се вика едновременно с други операции.
+ */
+template<typename T, typename A>
+void ConcurrentVector<T, A>::clear()
+{
+    size_t reserved = m_reserved.load(std::memory_order_acquire);
+    for (size_t index = 0; index < reserved; ++index)
+    {
+        if (!m_segments[segment_of(index)].load(std::memory_order_relaxed))
+        {
+            continue;                       // заделянето на сегмента е хвърлило изключение
+        }
+        state_type& slot_state = state(index);
+        if (slot_state.load(std::memory_order_relaxed) == slot_ready)
+        {
+            alloc_traits::destroy(m_alloc, slot(index));
+        }
+        slot_state.store(slot_empty, std::memory_order_relaxed);
+    }
+    m_reserved.store(0, std::memory_order_relaxed);
+    m_size.store(0, std::memory_order_release);
+}
+
+template<typename T, typename A>
+void ConcurrentVector<T, A>::release_segments()
+{
+    for (size_t k = 0; k < max_segments; ++k)
+    {
+        if (T* elements = m_segments[k].load(std::memory_order_relaxed))
+        {
+            alloc_traits::deallocate(m_alloc, elements, segment_size(k) + state_slots(k));
+            VECTOR_STATS_HOOK(vector_type_stats<T>().on_deallocate());
+            m_segments[k].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+}
+
+#endif // CONCURRENTVECTOR_H
@@ -0,0 +1,330 @@
+#ifndef FLATMAP_H
+#define FLATMAP_H
+
+#include "FlatSet.h"
+#include "Vector.h"
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+/**
+ *  Асоциативен масив, пазен в два успоредни Vector-а: сортирани уникални ключове
+ *  и стойностите им на същите позиции. Търсенето (flat_lower_bound) обхожда само
+ *  плътния масив от ключове, без да зарежда в кеша стойностите и без обхождане на
+ *  указатели между възли като при std::map. Подходящ е за таблици, които се четат
+ *  много по-често, отколкото се променят.
+ *
+ *  Построява се насипно от двойки (сортират се и повторенията се премахват наведнъж),
+ *  а много двойки се добавят чрез insert(first, last), който ги слива с наличните с
+ *  едно обхождане. Единичните emplace и erase изместват опашката на двата вектора.
+ *  При повторен ключ се запазва първата стойност, както при std::map::insert.
+ *
+ *      FlatMap<int, std::string> names{{20, "Ivan"}, {21, "Petur"}};
+ *      if (const std::string* name = names.find(20)) ...
+ *
+ *  K - тип на ключовете, V - тип на стойностите, Compare - строга наредба на ключовете
+ */
+template<typename K, typename V, typename Compare = std::less<K> >
+class FlatMap
+{
+public:
+    FlatMap() {}                                                                    // празна таблица
+    template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+    FlatMap(InputIt first, InputIt last, Compare comp = Compare());
+    FlatMap(std::initializer_list<std::pair<K, V> > items, Compare comp = Compare());
+
+    int size() const                    { return m_keys.size(); }                  // брой двойки
+    bool empty() const                  { return m_keys.empty(); }
+    const K& key(int i) const           { return m_keys[i]; }                      // i-ят ключ по ред
+    V& value(int i)                     { return m_values[i]; }                    // стойността на i-я ключ
+    const V& value(int i) const         { return m_values[i]; }
+    const Vector<K>& keys() const       { return m_keys; }                         // сортираните ключове
+    const Vector<V>& values() const     { return m_values; }                       // стойностите в реда на ключовете
+
+    int lower_bound(const K& key) const;
+    int index_of(const K& key) const;
+    bool contains(const K& key) const   { return index_of(key) >= 0; }
+    V* find(const K& key);
+    const V* find(const K& key) const;
+    V& at(const K& key);
+    const V& at(const K& key) const;
+    V& operator[](const K& key);
+
+    template<typename... Args>
+    bool emplace(const K& key, Args&&... args);
+    bool insert(const K& key, const V& value)   { return emplace(key, value); }
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last);
+    size_t erase(const K& key);
+    void clear();
+    void reserve(size_t n);
+
+private:
+    using item = std::pair<K, V>;
+
+    struct item_less
+    {
+        Compare comp;
+        bool operator()(const item& a, const item& b) const { return comp(a.first, b.first); }
+    };
+
+    template<typename InputIt>
+    static Vector<item> sorted_items(InputIt first, InputIt last, Compare comp);
+    template<typename... Args>
+    void emplace_at(int index, const K& key, Args&&... args);
+    void merge(Vector<item>& batch);
+
+    Vector<K> m_keys;       // сортирани, без повторения
+    Vector<V> m_values;     // m_values[i] е стойността на m_keys[i]
+    Compare m_comp;
+};
+
+/**
+ *  Събира двойките от [first, last) и ги сортира по ключ наведнъж, като от
+ *  повтарящите се ключове остава първата двойка.
+ */
+template<typename K, typename V, typename Compare>
+template<typename InputIt>
+Vector<typename FlatMap<K, V, Compare>::item> FlatMap<K, V, Compare>::sorted_items(InputIt first, InputIt last, Compare comp)
+{
+    Vector<item> items;
+    for (; first != last; ++first)
+    {
+        items.push_back(*first);
+    }
+    flat_sort_unique(items, item_less{comp});
+    return items;
+}
+
+/**
+ *  Насипно построяване от двойки ключ-стойност.
+ */
+template<typename K, typename V, typename Compare>
+template<typename InputIt, typename>
+FlatMap<K, V, Compare>::FlatMap(InputIt first, InputIt last, Compare comp)
+    : m_comp(comp)
+{
+    Vector<item> items = sorted_items(first, last, m_comp);
+    merge(items);
+}
+
+template<typename K, typename V, typename Compare>
+FlatMap<K, V, Compare>::FlatMap(std::initializer_list<std::pair<K, V> > items, Compare comp)
+    : FlatMap(items.begin(), items.end(), comp) {}
+
+/**
+ *  Позиция на първия ключ, който не е по-малък от key (size(), ако няма такъв).
+ */
+template<typename K, typename V, typename Compare>
+int FlatMap<K, V, Compare>::lower_bound(const K& key) const
+{
+    return static_cast<int>(flat_lower_bound(m_keys.data(), static_cast<size_t>(m_keys.size()), key, m_comp));
+}
+
+/**
+ *  Позиция на key или -1, ако го няма.
+ */
+template<typename K, typename V, typename Compare>
+int FlatMap<K, V, Compare>::index_of(const K& key) const
+{
+    int index = lower_bound(key);
+    return index < m_keys.size() && !m_comp(key, m_keys[index]) ? index : -1;
+}
+
+/**
+ *  Указател към стойността на key или nullptr, ако го няма.
+ */
+template<typename K, typename V, typename Compare>
+V* FlatMap<K, V, Compare>::find(const K& key)
+{
+    int index = index_of(key);
+    return index < 0 ? nullptr : &m_values[index];
+}
+
+template<typename K, typename V, typename Compare>
+const V* FlatMap<K, V, Compare>::find(const K& key) const
+{
+    int index = index_of(key);
+    return index < 0 ? nullptr : &m_values[index];
+}
+
+/**
+ *  Стойността на key; ако го няма, хвърля std::out_of_range.
+ */
+template<typename K, typename V, typename Compare>
+V& FlatMap<K, V, Compare>::at(const K& key)
+{
+    V* value = find(key);
+    if (!value)
+    {
+        throw std::out_of_range("FlatMap: key not found");
+    }
+    return *value;
+}
+
+template<typename K, typename V, typename Compare>
+const V& FlatMap<K, V, Compare>::at(const K& key) const
+{
+    const V* value = find(key);
+    if (!value)
+    {
+        throw std::out_of_range("FlatMap: key not found");
+    }
+    return *value;
+}
+
+/**
+ *  Стойността на key; ако го няма, първо се вмъква стойност по подразбиране.
+ */
+template<typename K, typename V, typename Compare>
+V& FlatMap<K, V, Compare>::operator[](const K& key)
+{
+    int index = lower_bound(key);
+    if (index == m_keys.size() || m_comp(key, m_keys[index]))
+    {
+        emplace_at(index, key);
+    }
+    return m_values[index];
+}
+
+/**
+ *  Вмъква key със стойност, конструирана от args, ако ключът още го няма.
+ *
+ *  @return true, ако двойката е добавена
+ */
+template<typename K, typename V, typename Compare>
+template<typename... Args>
+bool FlatMap<K, V, Compare>::emplace(const K& key, Args&&... args)
+{
+    int index = lower_bound(key);
+    if (index < m_keys.size() && !m_comp(key, m_keys[index]))
+    {
+        return false;
+    }
+    emplace_at(index, key, std::forward<Args>(args)...);
+    return true;
+}
+
+/**
+ *  Вмъква двойката на позиция index в двата вектора. Ако конструирането на
+ *  стойността хвърли, вече вмъкнатият ключ се премахва, за да останат успоредни.
+ */
+template<typename K, typename V, typename Compare>
+template<typename... Args>
+void FlatMap<K, V, Compare>::emplace_at(int index, const K& key, Args&&... args)
+{
+    m_keys.emplace(index, key);
+    try
+    {
+        m_values.emplace(index, std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        m_keys.erase(index);
+        throw;
+    }
+}
+
+/**
+ *  Добавя двойките от [first, last): те се сортират веднъж и се сливат с наличните
+ *  с едно обхождане. Вече наличните ключове запазват стойностите си.
+ */
+template<typename K, typename V, typename Compare>
+template<typename InputIt>
+void FlatMap<K, V, Compare>::insert(InputIt first, InputIt last)
+{
+    Vector<item> batch = sorted_items(first, last, m_comp);
+    merge(batch);
+}
+
+/**
+ *  Слива сортираните двойки без повторения от batch с таблицата. Ако всички нови
+ *  ключове са след последния наличен, двойките само се добавят в края.
+ */
+template<typename K, typename V, typename Compare>
+void FlatMap<K, V, Compare>::merge(Vector<item>& batch)
+{
+    if (batch.empty())
+    {
+        return;
+    }
+    if (m_keys.empty() || m_comp(m_keys.back(), batch[0].first))
+    {
+        reserve(m_keys.size() + batch.size());
+        for (int j = 0; j < batch.size(); ++j)
+        {
+            m_keys.push_back(std::move(batch[j].first));
+            try
+            {
+                m_values.push_back(std::move(batch[j].second));
+            }
+            catch (...)
+            {
+                m_keys.pop_back();      // двата вектора остават успоредни, както в emplace_at
+                throw;
+            }
+        }
+        return;
+    }
+
+    // Елементите, чието преместване може да хвърли, се копират: ако сливането
+    // бъде прекъснато, таблицата остава непроменена.
+    Vector<K> keys;
+    Vector<V> values;
+    keys.reserve(m_keys.size() + batch.size());
+    values.reserve(m_keys.size() + batch.size());
+    int i = 0, j = 0;
+    while (i < m_keys.size() || j < batch.size())
+    {
+        if (i == m_keys.size() || (j < batch.size() && m_comp(batch[j].first, m_keys[i])))
+        {
+            keys.push_back(std::move_if_noexcept(batch[j].first));
+            values.push_back(std::move_if_noexcept(batch[j].second));
+            ++j;
+        }
+        else
+        {
+            j += j < batch.size() && !m_comp(m_keys[i], batch[j].first);     // наличната стойност остава
+            keys.push_back(std::move_if_noexcept(m_keys[i]));
+            values.push_back(std::move_if_noexcept(m_values[i]));
+            ++i;
+        }
+    }
+    m_keys = std::move(keys);
+    m_values = std::move(values);
+}
+
+/**
+ *  Трие двойката с ключ key, ако я има.
+ *
+ *  @return брой изтрити двойки (0 или 1)
+ */
+template<typename K, typename V, typename Compare>
+size_t FlatMap<K, V, Compare>::erase(const K& key)
+{
+    int index = index_of(key);
+    if (index < 0)
+    {
+        return 0;
+    }
+    m_keys.erase(index);
+    m_values.erase(index);
+    return 1;
+}
+
+template<typename K, typename V, typename Compare>
+void FlatMap<K, V, Compare>::clear()
+{
+    m_keys.clear();
+    m_values.clear();
+}
+
+template<typename K, typename V, typename Compare>
+void FlatMap<K, V, Compare>::reserve(size_t n)
+{
+    m_keys.reserve(n);
+    m_values.reserve(n);
+}
+
+#endif // FLATMAP_H
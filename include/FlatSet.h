@@ -0,0 +1,258 @@
+#ifndef FLATSET_H
+#define FLATSET_H
+
+#include "Vector.h"
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+/**
+ *  Индекс на първия от n сортирани ключа, който не е по-малък от key (n, ако няма такъв).
+ *  Двоично търсене без разклонения: на всяка стъпка интервалът се разполовява с условен
+ *  избор (cmov) вместо с преход, затова няма грешно предсказани преходи, а броят на
+ *  стъпките е винаги log2(n).
+ */
+template<typename K, typename Compare>
+size_t flat_lower_bound(const K* keys, size_t n, const K& key, Compare comp)
+{
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    const K* base = keys;
+    while (n > 1)
+    {
+        size_t half = n / 2;
+        base = comp(base[half], key) ? base + half : base;
+        n -= half;
+    }
+    return (base - keys) + comp(*base, key);
+}
+
+/**
+ *  Сортира вектора наведнъж и премахва еквивалентните елементи (според less),
+ *  като от всяка група остава първият по ред. Основа на насипното построяване
+ *  на FlatSet и FlatMap.
+ */
+template<typename T, typename A, typename G, typename Less>
+void flat_sort_unique(Vector<T, A, G>& vec, Less less)
+{
+    T* first = vec.data();
+    T* last = first + vec.size();
+    std::stable_sort(first, last, less);
+    T* end = std::unique(first, last, [&less](const T& a, const T& b) { return !less(a, b); });
+    vec.erase(static_cast<int>(end - first), vec.size());
+}
+
+/**
+ *  Множество от уникални ключове, пазени сортирани в един Vector. Търсенето е
+ *  двоично без разклонения (flat_lower_bound) върху непрекъснат масив, без
+ *  обхождане на указатели между възли като при std::set, затова е подходящо
+ *  за таблици, които се четат много по-често, отколкото се променят.
+ *
+ *  Единичните insert и erase изместват опашката (O(n)); много ключове наведнъж
+ *  се добавят чрез insert(first, last), който ги сортира и слива с едно обхождане.
+ *
+ *  K - тип на ключовете, Compare - строга наредба (по подразбиране std::less<K>)
+ */
+template<typename K, typename Compare = std::less<K> >
+class FlatSet
+{
+public:
+    FlatSet() {}                                                                    // празно множество
+    explicit FlatSet(Vector<K> keys, Compare comp = Compare());
+    template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+    FlatSet(InputIt first, InputIt last, Compare comp = Compare());
+    FlatSet(std::initializer_list<K> keys, Compare comp = Compare());
+
+    int size() const                    { return m_keys.size(); }                  // брой ключове
+    bool empty() const                  { return m_keys.empty(); }
+    const K& operator[](int i) const    { return m_keys[i]; }                      // i-ят ключ по ред
+    const K* begin() const              { return m_keys.data(); }
+    const K* end() const                { return m_keys.data() + m_keys.size(); }
+    const Vector<K>& keys() const       { return m_keys; }                         // сортираните ключове
+
+    int lower_bound(const K& key) const;
+    int index_of(const K& key) const;
+    bool contains(const K& key) const   { return index_of(key) >= 0; }
+
+    bool insert(const K& key);
+    bool insert(K&& key);
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last);
+    size_t erase(const K& key);
+    void clear()                        { m_keys.clear(); }
+    void reserve(size_t n)              { m_keys.reserve(n); }
+
+private:
+    template<typename U>
+    bool insert_one(U&& key);
+    void merge(Vector<K>& batch);
+
+    Vector<K> m_keys;       // сортирани, без повторения
+    Compare m_comp;
+};
+
+/**
+ *  Насипно построяване: ключовете се сортират и повторенията се премахват наведнъж.
+ */
+template<typename K, typename Compare>
+FlatSet<K, Compare>::FlatSet(Vector<K> keys, Compare comp)
+    : m_keys(std::move(keys)), m_comp(comp)
+{
+    flat_sort_unique(m_keys, m_comp);
+}
+
+template<typename K, typename Compare>
+template<typename InputIt, typename>
+FlatSet<K, Compare>::FlatSet(InputIt first, InputIt last, Compare comp)
+    : m_comp(comp)
+{
+    for (; first != last; ++first)
+    {
+        m_keys.push_back(*first);
+    }
+    flat_sort_unique(m_keys, m_comp);
+}
+
+template<typename K, typename Compare>
+FlatSet<K, Compare>::FlatSet(std::initializer_list<K> keys, Compare comp)
+    : FlatSet(keys.begin(), keys.end(), comp) {}
+
+/**
+ *  Позиция на първия ключ, който не е по-малък от key (size(), ако няма такъв).
+ */
+template<typename K, typename Compare>
+int FlatSet<K, Compare>::lower_bound(const K& key) const
+{
+    return static_cast<int>(flat_lower_bound(m_keys.data(), static_cast<size_t>(m_keys.size()), key, m_comp));
+}
+
+/**
+ *  Позиция на key или -1, ако го няма.
+ */
+template<typename K, typename Compare>
+int FlatSet<K, Compare>::index_of(const K& key) const
+{
+    int index = lower_bound(key);
+    return index < m_keys.size() && !m_comp(key, m_keys[index]) ? index : -1;
+}
+
+template<typename K, typename Compare>
+bool FlatSet<K, Compare>::insert(const K& key)
+{
+    return insert_one(key);
+}
+
+template<typename K, typename Compare>
+bool FlatSet<K, Compare>::insert(K&& key)
+{
+    return insert_one(std::move(key));
+}
+
+/**
+ *  Вмъква key на мястото му в наредбата, ако вече го няма.
+ *
+ *  @return true, ако ключът е добавен
+ */
+template<typename K, typename Compare>
+template<typename U>
+bool FlatSet<K, Compare>::insert_one(U&& key)
+{
+    int index = lower_bound(key);
+    if (index < m_keys.size() && !m_comp(key, m_keys[index]))
+    {
+        return false;
+    }
+    m_keys.emplace(index, std::forward<U>(key));
+    return true;
+}
+
+/**
+ *  Добавя ключовете от [first, last): те се сортират и повторенията се премахват
+ *  веднъж, след което се сливат с наличните с едно обхождане, вместо да се
+ *  вмъква всеки поотделно с изместване на опашката.
+ */
+template<typename K, typename Compare>
+template<typename InputIt>
+void FlatSet<K, Compare>::insert(InputIt first, InputIt last)
+{
+    Vector<K> batch;
+    for (; first != last; ++first)
+    {
+        batch.push_back(*first);
+    }
+    flat_sort_unique(batch, m_comp);
+    merge(batch);
+}
+
+/**
+ *  Слива сортирания batch без повторения с ключовете на множеството. Ако всички
+ *  нови ключове са след последния наличен, те само се добавят в края.
+ */
+template<typename K, typename Compare>
+void FlatSet<K, Compare>::merge(Vector<K>& batch)
+{
+    if (batch.empty())
+    {
+        return;
+    }
+    if (m_keys.empty() || m_comp(m_keys.back(), batch[0]))
+    {
+        m_keys.reserve(m_keys.size() + batch.size());
+        for (int j = 0; j < batch.size(); ++j)
+        {
+            m_keys.push_back(std::move(batch[j]));
+        }
+        return;
+    }
+
+    // Ключовете, чието преместване може да хвърли, се копират: ако сливането
+    // бъде прекъснато, множеството остава непроменено.
+    Vector<K> merged;
+    merged.reserve(m_keys.size() + batch.size());
+    int i = 0, j = 0;
+    while (i < m_keys.size() && j < batch.size())
+    {
+        if (m_comp(batch[j], m_keys[i]))
+        {
+            merged.push_back(std::move_if_noexcept(batch[j++]));
+        }
+        else
+        {
+            j += !m_comp(m_keys[i], batch[j]);      // еднаквите ключове се пропускат
+            merged.push_back(std::move_if_noexcept(m_keys[i++]));
+        }
+    }
+    for (; i < m_keys.size(); ++i)
+    {
+        merged.push_back(std::move_if_noexcept(m_keys[i]));
+    }
+    for (; j < batch.size(); ++j)
+    {
+        merged.push_back(std::move_if_noexcept(batch[j]));
+    }
+    m_keys = std::move(merged);
+}
+
+/**
+ *  Трие key, ако го има.
+ *
+ *  @return брой изтрити ключове (0 или 1)
+ */
+template<typename K, typename Compare>
+size_t FlatSet<K, Compare>::erase(const K& key)
+{
+    int index = index_of(key);
+    if (index < 0)
+    {
+        return 0;
+    }
+    m_keys.erase(index);
+    return 1;
+}
+
+#endif // FLATSET_H
@@ -0,0 +1,124 @@
+#ifndef GROWTHPOLICY_H
+#define GROWTHPOLICY_H
+
+#include <algorithm>
+#include <cstddef>
+
+/**
+ *  Политики на растеж за Vector. Всяка политика е тип със следните статични функции:
+ *
+ *      // нов капацитет (в елементи), не по-малък от required, когато capacity не стига
+ *      static size_t grow(size_t capacity, size_t required, size_t element_size);
+ *
+ *      // капацитет след shrink_to_fit; ако върне capacity, векторът не се преоразмерява
+ *      static size_t shrink(size_t size, size_t capacity, size_t element_size);
+ *
+ *  Потребителска политика е всеки тип с този интерфейс:
+ *
+ *      Vector<int, std::allocator<int>, MyGrowth> v;
+ */
+
+/**
+ *  Геометричен растеж с множител Num / Den (по подразбиране 1.5). Празен вектор
+ *  получава Initial капацитет. shrink_to_fit смалява само когато свободният
+ *  капацитет надхвърля една стъпка на растеж, за да не се стигне до "трептене"
+ *  между смаляване и ново уголемяване.
+ */
+template<size_t Num = 3, size_t Den = 2, size_t Initial = 4>
+struct GeometricGrowth
+{
+    static_assert(Num > Den, "growth factor must be greater than one");
+
+    static size_t grow(size_t capacity, size_t required, size_t)
+    {
+        size_t grown = capacity ? (capacity * Num + Den - 1) / Den : Initial;
+        return std::max(grown, required);
+    }
+
+    static size_t shrink(size_t size, size_t capacity, size_t element_size)
+    {
+        return capacity > grow(size, size, element_size) ? size : capacity;
+    }
+};
+
+/**
+ *  Закръглява размер в байтове нагоре до класовете на jemalloc: 8, после през 16 до 128,
+ *  а след това по четири класа за всяко удвояване (160, 192, 224, 256, 320, ...).
+ *  Класовете на glibc malloc са през 16 байта, така че и за него няма загуба.
+ */
+inline size_t round_to_size_class(size_t bytes)
+{
+    if (bytes <= 8)
+    {
+        return 8;
+    }
+    if (bytes <= 128)
+    {
+        return (bytes + 15) & ~size_t(15);
+    }
+
+    size_t log2 = 0;                        // bytes е в интервала (2^log2, 2^(log2 + 1)]
+    for (size_t rest = bytes - 1; rest > 1; rest >>= 1)
+    {
+        ++log2;
+    }
+
+    size_t spacing = size_t(1) << (log2 - 2);
+    return (bytes + spacing - 1) & ~(spacing - 1);
+}
+
+/**
+ *  Геометричен растеж, чийто резултат се закръглява нагоре до класа на алокатора,
+ *  така че капацитетът използва целия блок, който malloc така или иначе ще даде.
+ */
+template<size_t Num = 3, size_t Den = 2, size_t Initial = 4>
+struct SizeClassGrowth
+{
+    static size_t fit(size_t count, size_t element_size)
+    {
+        return count ? round_to_size_class(count * element_size) / element_size : 0;
+    }
+
+    static size_t grow(size_t capacity, size_t required, size_t element_size)
+    {
+        return fit(GeometricGrowth<Num, Den, Initial>::grow(capacity, required, element_size), element_size);
+    }
+
+    static size_t shrink(size_t size, size_t capacity, size_t element_size)
+    {
+        size_t fitted = fit(size, element_size);
+        return capacity > GeometricGrowth<Num, Den, Initial>::grow(fitted, fitted, element_size) ? fitted : capacity;
+    }
+};
+
+/**
+ *  Геометричен растеж, при който буферите от поне Threshold байта се закръгляват
+ *  нагоре до цяла страница PageSize. Големите заделяния се обслужват директно с
+ *  mmap, така че остатъкът до края на страницата иначе би стоял неизползван.
+ */
+template<size_t Num = 3, size_t Den = 2, size_t PageSize = 4096, size_t Threshold = 64 * 1024, size_t Initial = 4>
+struct PageGrowth
+{
+    static size_t fit(size_t count, size_t element_size)
+    {
+        size_t bytes = count * element_size;
+        if (bytes < Threshold)
+        {
+            return count;
+        }
+        return ((bytes + PageSize - 1) / PageSize * PageSize) / element_size;
+    }
+
+    static size_t grow(size_t capacity, size_t required, size_t element_size)
+    {
+        return fit(GeometricGrowth<Num, Den, Initial>::grow(capacity, required, element_size), element_size);
+    }
+
+    static size_t shrink(size_t size, size_t capacity, size_t element_size)
+    {
+        size_t fitted = fit(size, element_size);
+        return capacity > GeometricGrowth<Num, Den, Initial>::grow(fitted, fitted, element_size) ? fitted : capacity;
+    }
+};
+
+#endif // GROWTHPOLICY_H
@@ -0,0 +1,512 @@
+#ifndef MAPPEDVECTOR_H
+#define MAPPEDVECTOR_H
+
+#include "GrowthPolicy.h"
+#include "VectorSimd.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ *  Начин на отваряне на файла на MappedVector:
+ *  read_only  - съществуващ файл, само за четене; мапва се наведнъж, без копиране;
+ *  read_write - съществуващ файл за четене и запис или нов празен файл, ако липсва;
+ *  create     - нов празен файл; съществуващ файл се изтрива.
+ */
+enum class MappedMode { read_only, read_write, create };
+
+/**
+ *  Подсказки към ядрото как ще се достъпва паметта (madvise).
+ */
+enum class MappedAdvice { normal, sequential, random, will_need, dont_need };
+
+/**
+ *  Заглавие в началото на файла. Заема 64 байта, така че елементите след него
+ *  започват на адрес, подравнен на кеш линия.
+ */
+struct MappedHeader
+{
+    char magic[8];                  // "MAPVEC01"
+    std::uint64_t element_size;     // sizeof(T) на записалия файла
+    std::uint64_t size;             // брой елементи
+    std::uint64_t reserved[5];
+};
+
+static_assert(sizeof(MappedHeader) == 64, "MappedHeader must be 64 bytes");
+
+/**
+ *  Вектор от тривиално копируеми елементи, чиято памет е мапнат файл (mmap) вместо
+ *  буфер от алокатор. Файлът е заглавие (MappedHeader), последвано от масива на
+ *  елементите, така че съдържанието е готово за ползване веднага след mmap:
+ *  огромен файл се отваря за милисекунди, а страниците се четат от диска при
+ *  първото им докосване.
+ *
+ *  push_back, resize и reserve имат семантиката на Vector: капацитетът расте по
+ *  политиката G, като файлът се удължава с ftruncate, а мапването - с mremap
+ *  (адресът на елементите може да се промени). При затваряне файлът се скъсява
+ *  до size() елемента. Броят на елементите се пази в заглавието, така че
+ *  промените са трайни след flush() или след унищожаването на вектора.
+ *
+ *  Вектор, отворен с MappedMode::read_only, е мапнат само за четене: операциите,
+ *  които го променят, хвърлят std::logic_error, а запис през operator[] е грешка.
+ *  Системните грешки се съобщават със std::system_error.
+ *
+ *  Т - шаблонен тип на елементите, G - политика на растеж (виж GrowthPolicy.h)
+ */
+template<typename T, typename G = GeometricGrowth<> >
+class MappedVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "MappedVector requires trivially copyable T");
+    static_assert(alignof(T) <= sizeof(MappedHeader), "MappedVector elements must fit the header alignment");
+
+public:
+    explicit MappedVector(const std::string& path, MappedMode mode = MappedMode::read_write);
+    MappedVector(const MappedVector& other) = delete;               // файлът има един собственик
+    MappedVector& operator=(const MappedVector& other) = delete;
+    MappedVector(MappedVector&& other);
+    MappedVector& operator=(MappedVector&& other);
+    ~MappedVector();
+
+    int capacity() const                { return static_cast<int>(m_capacity); }            // капацитет на файла в елементи
+    int size() const                    { return static_cast<int>(m_header->size); }        // връща броят елементи във вектора
+    bool empty() const                  { return m_header->size == 0; }                     // проверява дали векторът е празен
+    T& operator[](int i)                { return m_data[i]; }                               // дава достъп до i-я елемент на вектора
+    const T& operator[](int i) const    { return m_data[i]; }                               // дава read-only достъп до i-я елемент
+    T& back()                           { return m_data[m_header->size - 1]; }              // дава референция към последния елемент
+    T& front()                          { return m_data[0]; }                               // дава референция към първия елемент
+    T* data()                           { return m_data; }                                  // указател към мапнатия масив
+    const T* data() const               { return m_data; }
+    bool read_only() const              { return !m_writable; }                             // дали файлът е отворен само за четене
+
+    void clear();
+    void reserve(size_t new_capacity);
+    void resize(size_t new_size, const T& val = T());
+    void push_back(const T& val);
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
+    void pop_back();
+    void shrink_to_fit();
+
+    void flush(bool async = false);
+    void advise(MappedAdvice advice);
+
+private:
+    static constexpr char magic[8] = {'M', 'A', 'P', 'V', 'E', 'C', '0', '1'};
+
+    static size_t file_bytes(size_t capacity)   { return sizeof(MappedHeader) + capacity * sizeof(T); }
+
+    /**
+     *  Празно заглавие, към което сочи вектор без файл (напр. след преместване),
+     *  за да не проверява size() за nullptr.
+     */
+    static MappedHeader* empty_header()
+    {
+        static MappedHeader header = {};
+        return &header;
+    }
+
+    static void fail(const char* operation)
+    {
+        throw std::system_error(errno, std::generic_category(), std::string("MappedVector: ") + operation);
+    }
+
+    void check_writable() const;
+    void map(size_t length);
+    void remap(size_t new_capacity);
+    void close(bool truncate);
+
+    int m_fd = -1;
+    void* m_map = nullptr;
+    size_t m_length = 0;                            // дължина на мапването в байтове
+    size_t m_capacity = 0;
+    bool m_writable = false;
+    MappedHeader* m_header = empty_header();        // начало на мапването
+    T* m_data = nullptr;                            // масивът след заглавието
+};
+
+/**
+ *  Отваря или създава файла path и го мапва. При read_only файлът трябва да е
+ *  записан от MappedVector със същия размер на елементите.
+ *
+ *  @param  path    -   път до файла
+ *  @param  mode    -   начин на отваряне, виж MappedMode
+ */
+template<typename T, typename G>
+MappedVector<T, G>::MappedVector(const std::string& path, MappedMode mode)
+    : m_writable(mode != MappedMode::read_only)
+{
+    int flags = m_writable ? O_RDWR | O_CREAT : O_RDONLY;
+    if (mode == MappedMode::create)
+    {
+        flags |= O_TRUNC;
+    }
+    m_fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+    {
+        fail("open");
+    }
+
+    try
+    {
+        struct stat info;
+        if (::fstat(m_fd, &info) != 0)
+        {
+            fail("fstat");
+        }
+        size_t length = static_cast<size_t>(info.st_size);
+
+        bool fresh = length == 0 && m_writable;
+        if (fresh)
+        {
+            length = file_bytes(0);
+            if (::ftruncate(m_fd, length) != 0)
+            {
+                fail("ftruncate");
+            }
+        }
+        else if (length < sizeof(MappedHeader))
+        {
+            throw std::runtime_error("MappedVector: " + path + " is not a MappedVector file");
+        }
+
+        map(length);
+        if (fresh)
+        {
+            std::memcpy(m_header->magic, magic, sizeof(magic));
+            m_header->element_size = sizeof(T);
+            m_header->size = 0;
+        }
+        else if (std::memcmp(m_header->magic, magic, sizeof(magic)) != 0 || m_header->element_size != sizeof(T) ||
+                 m_header->size > m_capacity)
+        {
+            throw std::runtime_error("MappedVector: " + path + " has an incompatible header");
+        }
+    }
+    catch (...)
+    {
+        close(false);
+        throw;
+    }
+}
+
+/**
+ *  Преместващ конструктор: файлът и мапването преминават към новия обект.
+ */
+template<typename T, typename G>
+MappedVector<T, G>::MappedVector(MappedVector&& other)
+    : m_fd(other.m_fd), m_map(other.m_map), m_length(other.m_length), m_capacity(other.m_capacity),
+      m_writable(other.m_writable), m_header(other.m_header), m_data(other.m_data)
+{
+    other.m_fd = -1;
+    other.m_map = nullptr;
+    other.m_length = other.m_capacity = 0;
+    other.m_writable = false;
+    other.m_header = empty_header();
+    other.m_data = nullptr;
+}
+
+/**
+ *  Преместващо присвояване: текущият файл се затваря, а този на other се поема.
+ */
+template<typename T, typename G>
+MappedVector<T, G>& MappedVector<T, G>::operator=(MappedVector&& other)
+{
+    if (this != &other)
+    {
+        close(m_writable);
+        std::swap(m_fd, other.m_fd);
+        std::swap(m_map, other.m_map);
+        std::swap(m_length, other.m_length);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_writable, other.m_writable);
+        std::swap(m_header, other.m_header);
+        std::swap(m_data, other.m_data);
+    }
+    return *this;
+}
+
+/**
+ *  Деструктор: скъсява файла до size() елемента (ако е отворен за запис) и го затваря.
+ *  Записаните данни остават в кеша на страниците и ядрото ги записва на диска;
+ *  за гарантиран запис извикайте flush() преди това.
+ */
+template<typename T, typename G>
+MappedVector<T, G>::~MappedVector()
+{
+    close(m_writable);
+}
+
+template<typename T, typename G>
+void MappedVector<T, G>::check_writable() const
+{
+    if (!m_writable)
+    {
+        throw std::logic_error("MappedVector: the file is open read-only");
+    }
+}
+
+/**
+ *  Мапва първите length байта на файла и обновява указателите и капацитета.
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::map(size_t length)
+{
+    int protection = m_writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* p = ::mmap(nullptr, length, protection, MAP_SHARED, m_fd, 0);
+    if (p == MAP_FAILED)
+    {
+        fail("mmap");
+    }
+    m_map = p;
+    m_length = length;
+    m_capacity = (length - sizeof(MappedHeader)) / sizeof(T);
+    m_header = static_cast<MappedHeader*>(p);
+    m_data = reinterpret_cast<T*>(static_cast<char*>(p) + sizeof(MappedHeader));
+}
+
+/**
+ *  Променя капацитета на файла и на мапването. При нарастване файлът първо се
+ *  удължава, а при смаляване първо се смалява мапването, така че никога да не
+ *  е мапнат байт след края на файла. Под Linux мапването се променя на място или
+ *  се премества от ядрото с mremap, без копиране на данните.
+ *
+ *  @param  new_capacity    -   нов капацитет, не по-малък от броя на елементите
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::remap(size_t new_capacity)
+{
+    size_t length = file_bytes(new_capacity);
+    bool growing = length > m_length;
+    if (growing && ::ftruncate(m_fd, length) != 0)
+    {
+        fail("ftruncate");
+    }
+
+#ifdef __linux__
+    void* p = ::mremap(m_map, m_length, length, MREMAP_MAYMOVE);
+    if (p == MAP_FAILED)
+    {
+        int error = errno;
+        if (growing && ::ftruncate(m_fd, m_length) != 0) {}    // старото мапване остава валидно
+        errno = error;
+        fail("mremap");
+    }
+    m_map = p;
+    m_length = length;
+    m_capacity = new_capacity;
+    m_header = static_cast<MappedHeader*>(p);
+    m_data = reinterpret_cast<T*>(static_cast<char*>(p) + sizeof(MappedHeader));
+#else
+    // Новото мапване се прави, преди да се освободи старото, така че ако map хвърли,
+    // векторът остава непроменен. Съдържанието е във файла, затова новото мапване го вижда.
+    void* old_map = m_map;
+    size_t old_length = m_length;
+    try
+    {
+        map(length);
+    }
+    catch (...)
+    {
+        if (growing && ::ftruncate(m_fd, old_length) != 0) {}
+        throw;
+    }
+    ::munmap(old_map, old_length);
+#endif
+
+    if (!growing && ::ftruncate(m_fd, length) != 0)
+    {
+        fail("ftruncate");
+    }
+}
+
+/**
+ *  Освобождава мапването и файловия дескриптор.
+ *
+ *  @param  truncate    -   дали файлът да се скъси до size() елемента
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::close(bool truncate)
+{
+    size_t length = file_bytes(m_header->size);
+    if (m_map)
+    {
+        ::munmap(m_map, m_length);
+    }
+    if (m_fd >= 0)
+    {
+        if (truncate && length < m_length && ::ftruncate(m_fd, length) != 0) {}   // деструкторът не хвърля
+        ::close(m_fd);
+    }
+    m_fd = -1;
+    m_map = nullptr;
+    m_length = m_capacity = 0;
+    m_header = empty_header();
+    m_data = nullptr;
+}
+
+/**
+ *  Изтрива всички елементи. Капацитетът на файла остава непроменен.
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::clear()
+{
+    check_writable();
+    m_header->size = 0;
+}
+
+/**
+ *  Удължава файла до new_capacity елемента, ако е по-малък.
+ *
+ *  @param  new_capacity    -   естествено число, нов капацитет на вектора
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::reserve(size_t new_capacity)
+{
+    check_writable();
+    if (new_capacity > m_capacity)
+    {
+        remap(new_capacity);
+    }
+}
+
+/**
+ *  Оразмерява вектора; новите елементи са копия на val. Както при Vector,
+ *  капацитетът не се намалява.
+ *
+ *  @param  new_size    -   естествено число, нов брой на елементите на вектора
+ *  @param  val         -   стойност, с която да се инициализират новодобавените елементи
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::resize(size_t new_size, const T& val)
+{
+    check_writable();
+    size_t old_size = m_header->size;
+    if (old_size < new_size)
+    {
+        const T copy(val);      // val може да е елемент на вектора, а мапването да се премести
+        reserve(new_size);
+        if constexpr (simd_supported<T>::value)
+        {
+            simd_fill(m_data + old_size, new_size - old_size, copy);
+        }
+        else
+        {
+            std::uninitialized_fill(m_data + old_size, m_data + new_size, copy);
+        }
+    }
+    m_header->size = new_size;
+}
+
+/**
+ *  Добавя копие на val в края на вектора.
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::push_back(const T& val)
+{
+    emplace_back(val);
+}
+
+/**
+ *  Конструира нов елемент в края на вектора. При изчерпан капацитет файлът нараства
+ *  по политиката G; елементът се конструира предварително, защото аргументите
+ *  може да сочат към мапването, което ще се премести.
+ *
+ *  @param  args        -   аргументи за конструктора на новия елемент
+ *  @return референция към новия елемент
+ */
+template<typename T, typename G>
+template<typename... Args>
+T& MappedVector<T, G>::emplace_back(Args&&... args)
+{
+    check_writable();
+    size_t size = m_header->size;
+    if (size == m_capacity)
+    {
+        T value(std::forward<Args>(args)...);
+        remap(G::grow(m_capacity, size + 1, sizeof(T)));
+        ::new (static_cast<void*>(m_data + size)) T(value);
+    }
+    else
+    {
+        ::new (static_cast<void*>(m_data + size)) T(std::forward<Args>(args)...);
+    }
+    m_header->size = size + 1;
+    return m_data[size];
+}
+
+/**
+ *  pop_back() премахва последния елемент във вектора, ако има такъв.
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::pop_back()
+{
+    check_writable();
+    if (m_header->size)
+    {
+        --m_header->size;
+    }
+}
+
+/**
+ *  Смалява файла до броя на елементите, ако политиката G прецени, че си струва.
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::shrink_to_fit()
+{
+    check_writable();
+    size_t new_capacity = G::shrink(m_header->size, m_capacity, sizeof(T));
+    if (new_capacity < m_capacity)
+    {
+        remap(new_capacity);
+    }
+}
+
+/**
+ *  Записва променените страници на диска (msync). За вектор само за четене не прави нищо.
+ *
+ *  @param  async   -   ако е истина, записът само се планира и функцията не чака
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::flush(bool async)
+{
+    if (m_writable && m_map && ::msync(m_map, m_length, async ? MS_ASYNC : MS_SYNC) != 0)
+    {
+        fail("msync");
+    }
+}
+
+/**
+ *  Подава подсказка на ядрото за начина на достъп до целия файл, напр. sequential
+ *  за последователно обхождане (по-агресивно предварително четене) или will_need,
+ *  за да започне четенето от диска веднага след отварянето.
+ */
+template<typename T, typename G>
+void MappedVector<T, G>::advise(MappedAdvice advice)
+{
+    int flags = MADV_NORMAL;
+    switch (advice)
+    {
+        case MappedAdvice::normal:      flags = MADV_NORMAL;        break;
+        case MappedAdvice::sequential:  flags = MADV_SEQUENTIAL;    break;
+        case MappedAdvice::random:      flags = MADV_RANDOM;        break;
+        case MappedAdvice::will_need:   flags = MADV_WILLNEED;      break;
+        case MappedAdvice::dont_need:   flags = MADV_DONTNEED;      break;
+    }
+    if (m_map && ::madvise(m_map, m_length, flags) != 0)
+    {
+        fail("madvise");
+    }
+}
+
+#endif // MAPPEDVECTOR_H
@@ -0,0 +1,849 @@
+#ifndef SEGMENTEDVECTOR_H
+#define SEGMENTEDVECTOR_H
+
+#include "Vector.h"
+#include "VectorStats.h"
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/**
+ *  Брой битове на индекса в парче, така че едно парче да заема най-много
+ *  chunk_bytes байта (поне един елемент).
+ */
+constexpr size_t segmented_chunk_bits(size_t element_size, size_t chunk_bytes = 64 * 1024)
+{
+    size_t bits = 0;
+    while ((element_size << (bits + 1)) <= chunk_bytes)
+    {
+        ++bits;
+    }
+    return bits;
+}
+
+template<typename T, typename A, size_t ChunkBits>
+class SegmentedVector;
+
+template<typename T, typename A, size_t ChunkBits>
+void swap(SegmentedVector<T, A, ChunkBits>& a, SegmentedVector<T, A, ChunkBits>& b);
+
+template<typename T, typename A, size_t ChunkBits, typename U>
+size_t erase(SegmentedVector<T, A, ChunkBits>& vec, const U& value);
+
+template<typename T, typename A, size_t ChunkBits, typename Pred>
+size_t erase_if(SegmentedVector<T, A, ChunkBits>& vec, Pred pred);
+
+/**
+ *  Вектор със същия интерфейс като Vector, чиито елементи са в парчета с фиксиран
+ *  размер 2^ChunkBits, а указателите към парчетата са в директория (Vector<T*>).
+ *  Елемент i е в парче i >> ChunkBits на позиция i & (chunk_size - 1).
+ *
+ *  При нарастване се заделя само ново парче и се добавя указател в директорията:
+ *  елементите не се преместват никога, затова няма пикове на паметта и на закъснението,
+ *  както при преразпределянето на голям Vector, а референциите към елементите остават
+ *  валидни при добавяне в края. Цената е, че масивът не е непрекъснат: бързите
+ *  обхождания минават парче по парче чрез for_each_chunk.
+ *
+ *  Операциите, които намаляват броя на елементите, освобождават празните парчета в
+ *  края, като пазят едно резервно, за да не се заделя и освобождава парче при
+ *  редуване на push_back и pop_back на границата. shrink_to_fit освобождава и него.
+ *
+ *  Т - шаблонен тип на елементите, А - шаблонен тип на алокатора,
+ *  ChunkBits - log2 от броя елементи в парче (по подразбиране парчета от около 64 KiB)
+ */
+template<typename T, typename A = std::allocator<T>, size_t ChunkBits = segmented_chunk_bits(sizeof(T))>
+class SegmentedVector
+{
+public:
+    static constexpr size_t chunk_bits = ChunkBits;
+    static constexpr size_t chunk_size = size_t(1) << ChunkBits;       // брой елементи в парче
+
+    SegmentedVector() : SegmentedVector(A()) {}                                 // празен вектор, без заделени парчета
+    explicit SegmentedVector(const A& alloc) : m_chunks(chunk_alloc(alloc)), m_alloc(alloc) {}
+    SegmentedVector(size_t n, const T& val = T(), const A& alloc = A());
+    SegmentedVector(const SegmentedVector& other);
+    SegmentedVector(const SegmentedVector& other, const A& alloc);
+    SegmentedVector& operator=(const SegmentedVector& other);
+    SegmentedVector(SegmentedVector&& other);
+    SegmentedVector& operator=(SegmentedVector&& other);
+    ~SegmentedVector();
+
+    int capacity() const                { return m_chunks.size() << ChunkBits; }    // брой елементи в заделените парчета
+    int size() const                    { return static_cast<int>(m_size); }       // връща броят елементи във вектора
+    bool empty() const                  { return m_size == 0; }                     // проверява дали векторът е празен
+    T& operator[](int i)                { return *at(static_cast<size_t>(i)); }     // дава read-write достъп до i-я елемент на вектора
+    const T& operator[](int i) const    { return *at(static_cast<size_t>(i)); }     // дава read-only достъп до i-я елемент на вектора
+    T& back()                           { return *at(m_size - 1); }                 // дава референция към последния елемент
+    T& front()                          { return *at(0); }                          // дава референция към първия елемент
+    A get_allocator() const             { return m_alloc; }                         // връща копие на алокатора на вектора
+
+    int chunk_count() const             { return m_chunks.size(); }                 // брой заделени парчета
+    template<typename F>
+    void for_each_chunk(F f);
+    template<typename F>
+    void for_each_chunk(F f) const;
+
+    void clear();
+    void reserve(size_t new_capacity);
+    void resize(size_t new_size, const T& val = T());
+    void push_back(const T& val);
+    void push_back(T&& val);
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
+    template<typename... Args>
+    T& emplace(int index, Args&&... args);
+    void pop_back();
+    void insert(int index, const T& value);
+    void insert(int index, T&& value);
+    void insert(int index, size_t count, const T& value);
+    void insert(int index, std::initializer_list<T> values);
+    template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+    void insert(int index, InputIt first, InputIt last);
+    void erase(int index);
+    void erase(int first, int last);
+    void swap_erase(int index);
+    template<typename U>
+    size_t remove(const U& value);
+    template<typename Pred>
+    size_t remove_if(Pred pred);
+    void shrink_to_fit();
+
+    friend void swap<T, A, ChunkBits>(SegmentedVector<T, A, ChunkBits>& a, SegmentedVector<T, A, ChunkBits>& b);
+
+private:
+    using alloc_traits = std::allocator_traits<A>;
+    using chunk_allocator = typename alloc_traits::template rebind_alloc<T*>;
+
+    static constexpr size_t chunk_mask = chunk_size - 1;
+
+    static chunk_allocator chunk_alloc(const A& alloc)  { return chunk_allocator(alloc); }
+
+    T* at(size_t i) const               { return m_chunks[static_cast<int>(i >> ChunkBits)] + (i & chunk_mask); }
+
+    /**
+     *  Итератор с произволен достъп по индекс, чрез който стандартните алгоритми
+     *  (std::rotate, std::remove_if) работят през границите на парчетата.
+     *  Остава валиден, докато не се добави парче в директорията.
+     */
+    struct iterator
+    {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = T*;
+        using reference         = T&;
+
+        T* const* chunks;
+        difference_type index;
+
+        reference operator*() const                             { return chunks[index >> ChunkBits][index & chunk_mask]; }
+        pointer operator->() const                              { return &**this; }
+        reference operator[](difference_type n) const           { return *(*this + n); }
+        iterator& operator++()                                  { ++index; return *this; }
+        iterator operator++(int)                                { iterator old = *this; ++index; return old; }
+        iterator& operator--()                                  { --index; return *this; }
+        iterator operator--(int)                                { iterator old = *this; --index; return old; }
+        iterator& operator+=(difference_type n)                 { index += n; return *this; }
+        iterator& operator-=(difference_type n)                 { index -= n; return *this; }
+        iterator operator+(difference_type n) const             { return iterator{chunks, index + n}; }
+        friend iterator operator+(difference_type n, iterator it) { return it + n; }
+        iterator operator-(difference_type n) const             { return iterator{chunks, index - n}; }
+        difference_type operator-(const iterator& other) const  { return index - other.index; }
+        bool operator==(const iterator& other) const            { return index == other.index; }
+        bool operator!=(const iterator& other) const            { return index != other.index; }
+        bool operator<(const iterator& other) const             { return index < other.index; }
+        bool operator>(const iterator& other) const             { return index > other.index; }
+        bool operator<=(const iterator& other) const            { return index <= other.index; }
+        bool operator>=(const iterator& other) const            { return index >= other.index; }
+    };
+
+    iterator begin()                    { return iterator{m_chunks.data(), 0}; }
+    iterator end()                      { return iterator{m_chunks.data(), static_cast<std::ptrdiff_t>(m_size)}; }
+
+    void add_chunk();
+    void release_chunks(size_t keep);
+    void trim();
+
+    template<typename InputIt>
+    void append(InputIt first, size_t n);
+    void append_fill(size_t n, const T& val);
+    template<typename InputIt>
+    void append_range(int index, InputIt first, InputIt last);
+
+    size_t move(size_t first, size_t last, size_t dest);
+    void move_backward(size_t first, size_t last, size_t dest_last);
+    void destroy_tail(size_t new_size);
+
+    Vector<T*, chunk_allocator> m_chunks;   // директория: указатели към парчетата
+    A m_alloc;
+    size_t m_size = 0;
+};
+
+/**
+ *  Конструира count копия на val, като заделя наведнъж всички нужни парчета.
+ *
+ *  @param  count   - брой на елементите във вектора
+ *  @param  val     - стойност, с която да бъдат инициализирани елементите
+ *  @param  alloc   - алокатор, който да се грижи за управлението на паметта
+ */
+template<typename T, typename A, size_t ChunkBits>
+SegmentedVector<T, A, ChunkBits>::SegmentedVector(size_t count, const T& val, const A& alloc)
+    : SegmentedVector(alloc)
+{
+    try
+    {
+        append_fill(count, val);
+    }
+    catch (...)
+    {
+        clear();
+        release_chunks(0);
+        throw;
+    }
+}
+
+/**
+ *  Копиращ конструктор. Алокаторът се взима така, както го избере
+ *  select_on_container_copy_construction.
+ */
+template<typename T, typename A, size_t ChunkBits>
+SegmentedVector<T, A, ChunkBits>::SegmentedVector(const SegmentedVector& other)
+    : SegmentedVector(other, alloc_traits::select_on_container_copy_construction(other.m_alloc))
+{}
+
+/**
+ *  Копиращ конструктор, който заделя парчетата на копието чрез подадения алокатор.
+ *  Елементите се копират парче по парче.
+ */
+template<typename T, typename A, size_t ChunkBits>
+SegmentedVector<T, A, ChunkBits>::SegmentedVector(const SegmentedVector& other, const A& alloc)
+    : SegmentedVector(alloc)
+{
+    try
+    {
+        reserve(other.m_size);
+        other.for_each_chunk([this](const T* begin, const T* end)
+        {
+            append(begin, end - begin);
+        });
+    }
+    catch (...)
+    {
+        clear();
+        release_chunks(0);
+        throw;
+    }
+}
+
+/**
+ *  Оператор за копиращо присвояване чрез copy-and-swap, както при Vector.
+ *  Strong exception safety.
+ */
+template<typename T, typename A, size_t ChunkBits>
+SegmentedVector<T, A, ChunkBits>& SegmentedVector<T, A, ChunkBits>::operator=(const SegmentedVector& other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    SegmentedVector temp(other, alloc_traits::propagate_on_container_copy_assignment::value
+                                ? other.m_alloc : m_alloc);
+    *this = std::move(temp);
+    return *this;
+}
+
+/**
+ *  Преместващ конструктор: открадва се директорията, парчетата остават на място.
+ */
+template<typename T, typename A, size_t ChunkBits>
+SegmentedVector<T, A, ChunkBits>::SegmentedVector(SegmentedVector&& other)
+    : m_chunks(std::move(other.m_chunks)), m_alloc(other.m_alloc), m_size(other.m_size)
+{
+    other.m_size = 0;
+}
+
+/**
+ *  Оператор за преместващо присвояване. Ако алокаторът се разпространява при
+ *  преместване или двата алокатора са равни, парчетата на other се открадват.
+ *  В противен случай елементите се преместват един по един в наши парчета.
+ */
+template<typename T, typename A, size_t ChunkBits>
+SegmentedVector<T, A, ChunkBits>& SegmentedVector<T, A, ChunkBits>::operator=(SegmentedVector&& other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    clear();
+    if (alloc_traits::propagate_on_container_move_assignment::value || m_alloc == other.m_alloc)
+    {
+        release_chunks(0);
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+        {
+            m_alloc = other.m_alloc;
+        }
+        m_chunks = std::move(other.m_chunks);
+        m_size = other.m_size;
+        other.m_size = 0;
+    }
+    else
+    {
+        reserve(other.m_size);
+        append(std::make_move_iterator(other.begin()), other.m_size);
+        other.clear();
+    }
+    return *this;
+}
+
+/**
+ *  Деструктор, който унищожава елементите и освобождава всички парчета.
+ */
+template<typename T, typename A, size_t ChunkBits>
+SegmentedVector<T, A, ChunkBits>::~SegmentedVector()
+{
+    clear();
+    release_chunks(0);
+}
+
+/**
+ *  Извиква f(begin, end) за всяко непразно парче по реда на елементите, така че
+ *  обхождането е по непрекъснати масиви, без преобразуване на индекси:
+ *
+ *      vec.for_each_chunk([&](const double* begin, const double* end) { sum += simd_sum(begin, end - begin); });
+ *
+ *  @param  f   -   функция f(T* begin, T* end)
+ */
+template<typename T, typename A, size_t ChunkBits>
+template<typename F>
+void SegmentedVector<T, A, ChunkBits>::for_each_chunk(F f)
+{
+    for (size_t first = 0; first < m_size; first += chunk_size)
+    {
+        T* chunk = m_chunks[static_cast<int>(first >> ChunkBits)];
+        f(chunk, chunk + std::min(chunk_size, m_size - first));
+    }
+}
+
+template<typename T, typename A, size_t ChunkBits>
+template<typename F>
+void SegmentedVector<T, A, ChunkBits>::for_each_chunk(F f) const
+{
+    for (size_t first = 0; first < m_size; first += chunk_size)
+    {
+        const T* chunk = m_chunks[static_cast<int>(first >> ChunkBits)];
+        f(chunk, chunk + std::min(chunk_size, m_size - first));
+    }
+}
+
+/**
+ *  Заделя ново парче в края на директорията. Ако директорията не може да нарасне,
+ *  парчето се освобождава и изключението се препраща.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::add_chunk()
+{
+    T* chunk = alloc_traits::allocate(m_alloc, chunk_size);
+    try
+    {
+        m_chunks.push_back(chunk);
+    }
+    catch (...)
+    {
+        alloc_traits::deallocate(m_alloc, chunk, chunk_size);
+        throw;
+    }
+    VECTOR_STATS_HOOK(vector_type_stats<T>().on_allocate(chunk_size * sizeof(T)));
+}
+
+/**
+ *  Освобождава парчетата в края на директорията, докато останат keep.
+ *  Освободените парчета не бива да съдържат елементи.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::release_chunks(size_t keep)
+{
+    while (static_cast<size_t>(m_chunks.size()) > keep)
+    {
+        alloc_traits::deallocate(m_alloc, m_chunks.back(), chunk_size);
+        VECTOR_STATS_HOOK(vector_type_stats<T>().on_deallocate());
+        m_chunks.pop_back();
+    }
+}
+
+/**
+ *  Освобождава празните парчета в края, като пази едно резервно.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::trim()
+{
+    release_chunks(((m_size + chunk_mask) >> ChunkBits) + 1);
+}
+
+/**
+ *  Аналог на std::move за индекси: премества [first, last) наляво към dest, като
+ *  всяка стъпка е std::move между две непрекъснати части на парчета (memmove за
+ *  тривиалните типове).
+ *
+ *  @return индекс след последния преместен елемент
+ */
+template<typename T, typename A, size_t ChunkBits>
+size_t SegmentedVector<T, A, ChunkBits>::move(size_t first, size_t last, size_t dest)
+{
+    while (first != last)
+    {
+        size_t count = std::min({last - first, chunk_size - (first & chunk_mask), chunk_size - (dest & chunk_mask)});
+        std::move(at(first), at(first) + count, at(dest));
+        first += count;
+        dest += count;
+    }
+    return dest;
+}
+
+/**
+ *  Аналог на std::move_backward за индекси: премества [first, last) надясно, така
+ *  че последният елемент да отиде на dest_last - 1.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::move_backward(size_t first, size_t last, size_t dest_last)
+{
+    while (first != last)
+    {
+        size_t count = std::min({last - first, ((last - 1) & chunk_mask) + 1, ((dest_last - 1) & chunk_mask) + 1});
+        std::move_backward(at(last - count), at(last - 1) + 1, at(dest_last - 1) + 1);
+        last -= count;
+        dest_last -= count;
+    }
+}
+
+/**
+ *  Унищожава елементите в интервала [new_size, size()) и освобождава празните парчета.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::destroy_tail(size_t new_size)
+{
+    if constexpr (!std::is_trivially_destructible<T>::value || !is_plain_allocator<A>::value)
+    {
+        for (size_t i = new_size; i < m_size; ++i)
+        {
+            alloc_traits::destroy(m_alloc, at(i));
+        }
+    }
+    m_size = new_size;
+    trim();
+}
+
+/**
+ *  Процедура за унищожаване на всички елементи на вектора. Пази се само едно парче.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::clear()
+{
+    destroy_tail(0);
+}
+
+/**
+ *  Заделя парчетата, нужни за new_capacity елемента. Съществуващите елементи не се
+ *  преместват, а директорията нараства наведнъж.
+ *
+ *  @param  new_capacity    -   естествено число, нов капацитет на вектора
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::reserve(size_t new_capacity)
+{
+    size_t chunks = (new_capacity + chunk_mask) >> ChunkBits;
+    m_chunks.reserve(chunks);
+    while (static_cast<size_t>(m_chunks.size()) < chunks)
+    {
+        add_chunk();
+    }
+}
+
+/**
+ *  Конструира копия на n елемента, започващи от first (forward итератор), в края
+ *  на вектора, парче по парче. При изключение вече конструираните елементи остават във вектора, а
+ *  size() се увеличава с броя им, така че нищо не изтича.
+ */
+template<typename T, typename A, size_t ChunkBits>
+template<typename InputIt>
+void SegmentedVector<T, A, ChunkBits>::append(InputIt first, size_t n)
+{
+    reserve(m_size + n);
+    while (n)
+    {
+        T* dest = at(m_size);
+        size_t count = std::min(n, chunk_size - (m_size & chunk_mask));
+        if constexpr (is_plain_allocator<A>::value)
+        {
+            std::uninitialized_copy_n(first, count, dest);
+            std::advance(first, count);
+            m_size += count;
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i, ++first)
+            {
+                alloc_traits::construct(m_alloc, dest + i, *first);
+                ++m_size;
+            }
+        }
+        n -= count;
+    }
+}
+
+/**
+ *  Конструира n копия на val в края на вектора, парче по парче. При алокатор без
+ *  собствени construct/destroy всяко парче се запълва с std::uninitialized_fill_n.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::append_fill(size_t n, const T& val)
+{
+    reserve(m_size + n);
+    while (n)
+    {
+        T* dest = at(m_size);
+        size_t count = std::min(n, chunk_size - (m_size & chunk_mask));
+        if constexpr (is_plain_allocator<A>::value)
+        {
+            std::uninitialized_fill_n(dest, count, val);
+            m_size += count;
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                alloc_traits::construct(m_alloc, dest + i, val);
+                ++m_size;
+            }
+        }
+        n -= count;
+    }
+}
+
+/**
+ *  Оразмерява вектора: новите елементи са копия на val, а при смаляване излишните
+ *  елементи се унищожават и празните парчета в края се освобождават.
+ *
+ *  @param  new_size    -   естествено число, нов брой на елементите на вектора
+ *  @param  val         -   стойност, с която да се инициализират новодобавените елементи
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::resize(size_t new_size, const T& val)
+{
+    if (m_size < new_size)
+    {
+        const T copy(val);      // val може да е елемент на вектора
+        append_fill(new_size - m_size, copy);
+    }
+    else
+    {
+        destroy_tail(new_size);
+    }
+}
+
+/**
+ *  Добавя копие на val в края на вектора.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::push_back(const T& val)
+{
+    emplace_back(val);
+}
+
+/**
+ *  Вариант на push_back, който премества временен обект, вместо да го копира.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::push_back(T&& val)
+{
+    emplace_back(std::move(val));
+}
+
+/**
+ *  Конструира нов елемент в края на вектора. Ако последното парче е пълно, се
+ *  заделя ново; съществуващите елементи не се местят, затова args може спокойно
+ *  да сочат към елемент на вектора.
+ *
+ *  @param  args        -   аргументи за конструктора на новия елемент
+ *  @return референция към новия елемент
+ */
+template<typename T, typename A, size_t ChunkBits>
+template<typename... Args>
+T& SegmentedVector<T, A, ChunkBits>::emplace_back(Args&&... args)
+{
+    if (m_size == static_cast<size_t>(capacity()))
+    {
+        add_chunk();
+    }
+    T* slot = at(m_size);
+    alloc_traits::construct(m_alloc, slot, std::forward<Args>(args)...);
+    ++m_size;
+    return *slot;
+}
+
+/**
+ *  Конструира нов елемент на позиция index. Елементите вдясно от index се
+ *  изместват с една позиция; новият елемент първо се конструира във временен
+ *  обект, защото аргументите може да сочат към елемент, който ще бъде изместен.
+ *
+ *  @param  index   -   позиция на вмъкване във вектора
+ *  @param  args    -   аргументи за конструктора на новия елемент
+ *  @return референция към новия елемент
+ */
+template<typename T, typename A, size_t ChunkBits>
+template<typename... Args>
+T& SegmentedVector<T, A, ChunkBits>::emplace(int index, Args&&... args)
+{
+    T value(std::forward<Args>(args)...);
+    if (static_cast<size_t>(index) == m_size)
+    {
+        return emplace_back(std::move(value));
+    }
+
+    emplace_back(std::move(back()));
+    move_backward(index, m_size - 2, m_size - 1);
+    T& slot = (*this)[index];
+    slot = std::move(value);
+    return slot;
+}
+
+/**
+ *  pop_back() унищожава последния елемент във вектора, ако има такъв.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::pop_back()
+{
+    if (!empty())
+    {
+        destroy_tail(m_size - 1);
+    }
+}
+
+/**
+ *  Вмъква копие на value на позиция index.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::insert(int index, const T& value)
+{
+    emplace(index, value);
+}
+
+/**
+ *  Вариант на insert, който премества временен обект, вместо да го копира.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::insert(int index, T&& value)
+{
+    emplace(index, std::move(value));
+}
+
+/**
+ *  Вмъква count копия на value, започвайки от позиция index. value се копира
+ *  предварително, защото може да е елемент на вектора, който ще бъде изместен.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::insert(int index, size_t count, const T& value)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const T copy(value);
+    size_t old_size = m_size;
+    try
+    {
+        append_fill(count, copy);
+    }
+    catch (...)
+    {
+        destroy_tail(old_size);
+        throw;
+    }
+    std::rotate(begin() + index, begin() + old_size, end());
+}
+
+/**
+ *  Вмъква елементите на списъка values, започвайки от позиция index.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::insert(int index, std::initializer_list<T> values)
+{
+    append_range(index, values.begin(), values.end());
+}
+
+/**
+ *  Вмъква копия на елементите от интервала [first, last), започвайки от позиция index.
+ *  Интервалът не бива да сочи към елементи на самия вектор.
+ */
+template<typename T, typename A, size_t ChunkBits>
+template<typename InputIt, typename>
+void SegmentedVector<T, A, ChunkBits>::insert(int index, InputIt first, InputIt last)
+{
+    append_range(index, first, last);
+}
+
+/**
+ *  Добавя елементите от [first, last) в края и ги завърта на позиция index със
+ *  std::rotate. Добавянето не мести съществуващите елементи, затова се ползва и за
+ *  итератори с еднократно обхождане. При изключение добавените елементи се премахват.
+ */
+template<typename T, typename A, size_t ChunkBits>
+template<typename InputIt>
+void SegmentedVector<T, A, ChunkBits>::append_range(int index, InputIt first, InputIt last)
+{
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+
+    size_t old_size = m_size;
+    try
+    {
+        if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+        {
+            append(first, std::distance(first, last));
+        }
+        else
+        {
+            for (; first != last; ++first)
+            {
+                emplace_back(*first);
+            }
+        }
+    }
+    catch (...)
+    {
+        destroy_tail(old_size);
+        throw;
+    }
+    std::rotate(begin() + index, begin() + old_size, end());
+}
+
+/**
+ *  erase трие елемента на позиция index, ако има елементи въобще.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::erase(int index)
+{
+    if (empty())
+    {
+        return;
+    }
+
+    erase(index, index + 1);
+}
+
+/**
+ *  Трие елементите в интервала [first, last): опашката се премества наляво върху
+ *  тях парче по парче, след което се унищожават останалите в края преместени обекти.
+ *
+ *  @param  first   -   позиция на първия елемент, който да се изтрие (включително)
+ *  @param  last    -   позиция на последния елемент, който да се изтрие (изключващо)
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::erase(int first, int last)
+{
+    if (first == last)
+    {
+        return;
+    }
+
+    destroy_tail(move(last, m_size, first));
+}
+
+/**
+ *  Трие елемента на позиция index за константно време, без да запазва наредбата:
+ *  на мястото му се премества последният елемент на вектора.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::swap_erase(int index)
+{
+    T* last = at(m_size - 1);
+    T* pos = at(index);
+    if (pos != last)
+    {
+        *pos = std::move(*last);
+    }
+    destroy_tail(m_size - 1);
+}
+
+/**
+ *  Трие всички елементи, равни на value. value не бива да е елемент на самия вектор.
+ *
+ *  @return броят на изтритите елементи
+ */
+template<typename T, typename A, size_t ChunkBits>
+template<typename U>
+size_t SegmentedVector<T, A, ChunkBits>::remove(const U& value)
+{
+    return remove_if([&value](const T& element) { return element == value; });
+}
+
+/**
+ *  Трие всички елементи, за които pred връща истина, с едно обхождане на вектора.
+ *
+ *  @return броят на изтритите елементи
+ */
+template<typename T, typename A, size_t ChunkBits>
+template<typename Pred>
+size_t SegmentedVector<T, A, ChunkBits>::remove_if(Pred pred)
+{
+    iterator new_end = std::remove_if(begin(), end(), pred);
+    size_t removed = m_size - new_end.index;
+    destroy_tail(new_end.index);
+    return removed;
+}
+
+/**
+ *  Освобождава всички парчета след последния елемент, включително резервното,
+ *  и смалява директорията. Елементите не се преместват.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void SegmentedVector<T, A, ChunkBits>::shrink_to_fit()
+{
+    release_chunks((m_size + chunk_mask) >> ChunkBits);
+    m_chunks.shrink_to_fit();
+}
+
+/**
+ *  Разменя директориите и броя елементи на двата вектора. Както при Vector,
+ *  алокаторите се разменят само ако се разпространяват при размяна, иначе
+ *  трябва да са равни.
+ */
+template<typename T, typename A, size_t ChunkBits>
+void swap(SegmentedVector<T, A, ChunkBits>& a, SegmentedVector<T, A, ChunkBits>& b)
+{
+    if constexpr (std::allocator_traits<A>::propagate_on_container_swap::value)
+    {
+        std::swap(a.m_alloc, b.m_alloc);
+    }
+    else
+    {
+        assert(a.m_alloc == b.m_alloc && "SegmentedVector: swap of vectors with unequal allocators");
+    }
+    swap(a.m_chunks, b.m_chunks);
+    std::swap(a.m_size, b.m_size);
+}
+
+/**
+ *  Трие всички елементи на vec, равни на value. Аналог на std::erase.
+ */
+template<typename T, typename A, size_t ChunkBits, typename U>
+size_t erase(SegmentedVector<T, A, ChunkBits>& vec, const U& value)
+{
+    return vec.remove(value);
+}
+
+/**
+ *  Трие всички елементи на vec, за които pred е истина. Аналог на std::erase_if.
+ */
+template<typename T, typename A, size_t ChunkBits, typename Pred>
+size_t erase_if(SegmentedVector<T, A, ChunkBits>& vec, Pred pred)
+{
+    return vec.remove_if(pred);
+}
+
+#endif // SEGMENTEDVECTOR_H
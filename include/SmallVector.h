@@ -0,0 +1,277 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include "Vector.h"
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+/**
+ *  Вграден буфер за N елемента от тип T. Паметта не е инициализирана,
+ *  а in_use показва дали буферът в момента е даден на вектор.
+ */
+template<typename T, size_t N>
+struct InlineBuffer
+{
+    alignas(T) unsigned char storage[N * sizeof(T)];
+    bool in_use = false;
+
+    T* begin()                          { return reinterpret_cast<T*>(storage); }
+    bool owns(const T* p) const         { return p == reinterpret_cast<const T*>(storage); }
+};
+
+/**
+ *  Алокатор, който дава вградения буфер на заявки до N елемента (ако буферът е свободен),
+ *  а по-големите заявки пренасочва към std::allocator. Без буфер (buffer == nullptr)
+ *  алокаторът заделя само в динамичната памет. Така Vector може да работи върху
+ *  вградената памет на SmallVector без никаква промяна в алгоритмите си.
+ */
+template<typename T, size_t N>
+class InlineAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+
+    template<typename U>
+    struct rebind { using other = InlineAllocator<U, N>; };
+
+    InlineAllocator() noexcept : m_buffer(nullptr) {}
+    explicit InlineAllocator(InlineBuffer<T, N>* buffer) noexcept : m_buffer(buffer) {}
+
+    template<typename U>
+    InlineAllocator(const InlineAllocator<U, N>&) noexcept : m_buffer(nullptr) {}
+
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n);
+
+    /**
+     *  Копие на вектор не бива да ползва вградения буфер на оригинала,
+     *  затова копието получава алокатор без буфер.
+     */
+    InlineAllocator select_on_container_copy_construction() const { return InlineAllocator(); }
+
+    const InlineBuffer<T, N>* buffer() const noexcept { return m_buffer; }
+
+private:
+    InlineBuffer<T, N>* m_buffer;       // вграденият буфер на собственика на алокатора
+};
+
+template<typename T, size_t N>
+T* InlineAllocator<T, N>::allocate(size_t n)
+{
+    if (m_buffer && !m_buffer->in_use && n <= N)
+    {
+        m_buffer->in_use = true;
+        return m_buffer->begin();
+    }
+    return std::allocator<T>().allocate(n);
+}
+
+template<typename T, size_t N>
+void InlineAllocator<T, N>::deallocate(T* p, size_t n)
+{
+    if (m_buffer && m_buffer->owns(p))
+    {
+        m_buffer->in_use = false;
+        return;
+    }
+    std::allocator<T>().deallocate(p, n);
+}
+
+template<typename T, typename U, size_t N>
+bool operator==(const InlineAllocator<T, N>& a, const InlineAllocator<U, N>& b) noexcept
+{
+    return static_cast<const void*>(a.buffer()) == static_cast<const void*>(b.buffer());
+}
+
+template<typename T, typename U, size_t N>
+bool operator!=(const InlineAllocator<T, N>& a, const InlineAllocator<U, N>& b) noexcept
+{
+    return !(a == b);
+}
+
+/**
+ *  Вектор, който пази до N елемента във вграден буфер и минава към динамичната памет
+ *  едва когато буферът се препълни. Реализиран е като Vector, чийто алокатор е свързан
+ *  с вградения буфер, затова има същия интерфейс и същото разположение first/space/last
+ *  на VectorBase. Буферът е базов клас, за да бъде конструиран преди Vector.
+ *  Т - шаблонен тип на елементите, N - брой на елементите във вградения буфер
+ */
+template<typename T, size_t N>
+class SmallVector : private InlineBuffer<T, N>, public Vector<T, InlineAllocator<T, N> >
+{
+    static_assert(N > 0, "SmallVector needs room for at least one inline element");
+
+private:
+    using Buffer = InlineBuffer<T, N>;
+    using Base = Vector<T, InlineAllocator<T, N> >;
+
+public:
+    SmallVector() : Base(InlineAllocator<T, N>(buffer()))                       { Base::reserve(N); }
+    SmallVector(size_t n, const T& val = T());
+    SmallVector(std::initializer_list<T> values);
+    SmallVector(const SmallVector& other);
+    SmallVector& operator=(const SmallVector& other);
+    SmallVector(SmallVector&& other);
+    SmallVector& operator=(SmallVector&& other);
+
+    bool is_inline() const              { return this->base.first == buffer_begin(); }  // дали елементите са във вградения буфер
+    void shrink_to_fit();
+
+private:
+    Buffer* buffer()                    { return static_cast<Buffer*>(this); }
+    const T* buffer_begin() const       { return reinterpret_cast<const T*>(static_cast<const Buffer*>(this)->storage); }
+
+    void steal(SmallVector& other);
+    void move_to_inline();
+};
+
+/**
+ *  Конструира n копия на val; ако n <= N, те са във вградения буфер.
+ */
+template<typename T, size_t N>
+SmallVector<T, N>::SmallVector(size_t n, const T& val)
+    : SmallVector()
+{
+    Base::insert(0, n, val);
+}
+
+template<typename T, size_t N>
+SmallVector<T, N>::SmallVector(std::initializer_list<T> values)
+    : SmallVector()
+{
+    Base::insert(0, values);
+}
+
+/**
+ *  Копиращ конструктор. Копието ползва собствения си вграден буфер.
+ */
+template<typename T, size_t N>
+SmallVector<T, N>::SmallVector(const SmallVector& other)
+    : SmallVector()
+{
+    Base::insert(0, other.base.first, other.base.space);
+}
+
+/**
+ *  Копиращо присвояване. Елементите се копират в текущия буфер (вграден или не),
+ *  вместо във временен вектор, който би се озовал в динамичната памет.
+ */
+template<typename T, size_t N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(const SmallVector& other)
+{
+    if (this != &other)
+    {
+        Base::clear();
+        Base::insert(0, other.base.first, other.base.space);
+    }
+    return *this;
+}
+
+/**
+ *  Преместващ конструктор. Ако other е в динамичната памет, буферът му се открадва,
+ *  в противен случай елементите се преместват един по един във вградения буфер.
+ */
+template<typename T, size_t N>
+SmallVector<T, N>::SmallVector(SmallVector&& other)
+    : SmallVector()
+{
+    steal(other);
+}
+
+template<typename T, size_t N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(SmallVector&& other)
+{
+    if (this != &other)
+    {
+        Base::clear();
+        steal(other);
+    }
+    return *this;
+}
+
+/**
+ *  Взима елементите на other, като *this трябва да е празен. Динамичният буфер на other
+ *  се открадва и other се връща към своя вграден буфер; вградените елементи на other
+ *  се преместват, защото буферът им не може да смени собственика си.
+ */
+template<typename T, size_t N>
+void SmallVector<T, N>::steal(SmallVector& other)
+{
+    if (other.is_inline())
+    {
+        if (!is_inline())
+        {
+            move_to_inline();
+        }
+        Base::insert(0, std::make_move_iterator(other.base.first), std::make_move_iterator(other.base.space));
+        other.clear();
+        return;
+    }
+
+    Base::alloc_traits::deallocate(this->base.alloc, this->base.first, this->base.last - this->base.first);
+    this->base.first = other.base.first;
+    this->base.space = other.base.space;
+    this->base.last = other.base.last;
+
+    other.base.first = other.base.space = Base::alloc_traits::allocate(other.base.alloc, N);
+    other.base.last = other.base.first + N;
+}
+
+/**
+ *  Премества елементите от динамичната памет обратно във вградения буфер и
+ *  освобождава динамичния буфер. Изисква size() <= N.
+ */
+template<typename T, size_t N>
+void SmallVector<T, N>::move_to_inline()
+{
+    VectorBase<T, InlineAllocator<T, N> > heap(std::move(this->base));     // освобождава се при излизане
+
+    this->base.first = this->base.space = Base::alloc_traits::allocate(this->base.alloc, N);
+    this->base.last = this->base.first + N;
+
+    Base::insert(0, std::make_move_iterator(heap.first), std::make_move_iterator(heap.space));
+    for (T* cursor = heap.first; cursor != heap.space; ++cursor)
+    {
+        Base::alloc_traits::destroy(this->base.alloc, cursor);
+    }
+}
+
+/**
+ *  Вграденият буфер не може да се смали, затова shrink_to_fit има ефект само
+ *  в динамичната памет; ако елементите се поберат в N, те се връщат във вградения буфер.
+ */
+template<typename T, size_t N>
+void SmallVector<T, N>::shrink_to_fit()
+{
+    if (is_inline())
+    {
+        return;
+    }
+
+    if (Base::size() <= static_cast<int>(N))
+    {
+        move_to_inline();
+    }
+    else
+    {
+        Base::shrink_to_fit();
+    }
+}
+
+/**
+ *  Размяна на два SmallVector чрез три премествания, защото вградените буфери
+ *  не могат да бъдат разменени чрез размяна на указатели.
+ */
+template<typename T, size_t N>
+void swap(SmallVector<T, N>& a, SmallVector<T, N>& b)
+{
+    SmallVector<T, N> temp(std::move(a));
+    a = std::move(b);
+    b = std::move(temp);
+}
+
+#endif // SMALLVECTOR_H
@@ -0,0 +1,580 @@
+#ifndef SOAVECTOR_H
+#define SOAVECTOR_H
+
+#include "AlignedAllocator.h"
+#include "GrowthPolicy.h"
+#include "VectorTraits.h"
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ *  Непрекъснат изглед към една колона на SoaVector: указател и брой елементи.
+ *  Остава валиден, докато векторът не се преразпредели или не промени размера си.
+ */
+template<typename T>
+class SoaColumn
+{
+public:
+    SoaColumn(T* data, int size) : m_data(data), m_size(size) {}
+
+    T* data() const                     { return m_data; }                  // указател към първия елемент на колоната
+    int size() const                    { return m_size; }                  // брой елементи (редове)
+    bool empty() const                  { return m_size == 0; }
+    T& operator[](int i) const          { return m_data[i]; }
+    T* begin() const                    { return m_data; }
+    T* end() const                      { return m_data + m_size; }
+
+private:
+    T* m_data;
+    int m_size;
+};
+
+template<typename... Ts>
+class SoaVector;
+
+template<typename... Ts>
+void swap(SoaVector<Ts...>& a, SoaVector<Ts...>& b);
+
+/**
+ *  Вектор от записи с полета Ts..., съхранени по колони (structure of arrays): всяко
+ *  поле е в собствен непрекъснат масив, а всички колони имат общи размер и капацитет
+ *  и растат заедно, както Vector::reserve. Обхождане на едно поле чете само неговата
+ *  колона, без да зарежда в кеша останалите полета на записа (напр. низовете).
+ *
+ *  Колоните са в един общ блок от AlignedAllocator: всяка започва на граница от 64
+ *  байта, така че векторизираните ядра от VectorSimd.h работят директно върху тях,
+ *  а големите таблици са в прозрачни големи страници.
+ *
+ *  Редовете се достъпват чрез std::tuple от референции към полетата (proxy референция),
+ *  а колоните - чрез column<I>():
+ *
+ *      SoaVector<std::string, int> students;
+ *      students.emplace_back("Ivan", 20);
+ *      auto [name, age] = students[0];                         // референции към полетата
+ *      SoaColumn<const int> ages = students.column<1>();
+ *      int total = simd_sum(ages.data(), ages.size());
+ */
+template<typename... Ts>
+class SoaVector
+{
+    static_assert(sizeof...(Ts) > 0, "SoaVector: at least one column is required");
+
+public:
+    static constexpr size_t column_count = sizeof...(Ts);
+    static constexpr size_t COLUMN_ALIGNMENT = 64;          // подравняване на началото на всяка колона
+
+    static_assert(((alignof(Ts) <= COLUMN_ALIGNMENT) && ...), "SoaVector: column alignment exceeds 64 bytes");
+
+    template<size_t I>
+    using column_type = typename std::tuple_element<I, std::tuple<Ts...> >::type;
+
+    using value_type = std::tuple<Ts...>;                   // ред по стойност
+    using reference = std::tuple<Ts&...>;                   // ред като референции към полетата
+    using const_reference = std::tuple<const Ts&...>;
+
+    /**
+     *  Итератор по редовете с произволен достъп. Както при std::vector<bool>, operator*
+     *  връща proxy референция (reference или const_reference) по стойност.
+     */
+    template<bool Const>
+    struct row_iterator
+    {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = SoaVector::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = typename std::conditional<Const, SoaVector::const_reference, SoaVector::reference>::type;
+        using owner_type        = typename std::conditional<Const, const SoaVector, SoaVector>::type;
+
+        owner_type* owner;
+        difference_type index;
+
+        reference operator*() const                                     { return (*owner)[static_cast<int>(index)]; }
+        reference operator[](difference_type n) const                   { return (*owner)[static_cast<int>(index + n)]; }
+        row_iterator& operator++()                                      { ++index; return *this; }
+        row_iterator operator++(int)                                    { row_iterator old = *this; ++index; return old; }
+        row_iterator& operator--()                                      { --index; return *this; }
+        row_iterator operator--(int)                                    { row_iterator old = *this; --index; return old; }
+        row_iterator& operator+=(difference_type n)                     { index += n; return *this; }
+        row_iterator& operator-=(difference_type n)                     { index -= n; return *this; }
+        row_iterator operator+(difference_type n) const                 { return row_iterator{owner, index + n}; }
+        friend row_iterator operator+(difference_type n, row_iterator it) { return it + n; }
+        row_iterator operator-(difference_type n) const                 { return row_iterator{owner, index - n}; }
+        difference_type operator-(const row_iterator& other) const      { return index - other.index; }
+        bool operator==(const row_iterator& other) const                { return index == other.index; }
+        bool operator!=(const row_iterator& other) const                { return index != other.index; }
+        bool operator<(const row_iterator& other) const                 { return index < other.index; }
+        bool operator>(const row_iterator& other) const                 { return index > other.index; }
+        bool operator<=(const row_iterator& other) const                { return index <= other.index; }
+        bool operator>=(const row_iterator& other) const                { return index >= other.index; }
+    };
+
+    using iterator = row_iterator<false>;
+    using const_iterator = row_iterator<true>;
+
+    SoaVector() : m_columns(), m_capacity(0), m_size(0) {}                      // празен вектор, без заделена памет
+    explicit SoaVector(size_t n, const value_type& row = value_type());
+    SoaVector(std::initializer_list<value_type> rows);
+    SoaVector(const SoaVector& other);
+    SoaVector& operator=(const SoaVector& other);
+    SoaVector(SoaVector&& other) noexcept;
+    SoaVector& operator=(SoaVector&& other) noexcept;
+    ~SoaVector();
+
+    int capacity() const                { return static_cast<int>(m_capacity); }   // общ капацитет на колоните
+    int size() const                    { return static_cast<int>(m_size); }       // брой редове
+    bool empty() const                  { return m_size == 0; }
+    reference operator[](int i)         { return row(static_cast<size_t>(i), indices()); }
+    const_reference operator[](int i) const { return row(static_cast<size_t>(i), indices()); }
+    reference front()                   { return (*this)[0]; }
+    reference back()                    { return (*this)[size() - 1]; }
+
+    template<size_t I>
+    SoaColumn<column_type<I> > column()             { return SoaColumn<column_type<I> >(std::get<I>(m_columns), size()); }
+    template<size_t I>
+    SoaColumn<const column_type<I> > column() const { return SoaColumn<const column_type<I> >(std::get<I>(m_columns), size()); }
+
+    iterator begin()                    { return iterator{this, 0}; }
+    iterator end()                      { return iterator{this, static_cast<std::ptrdiff_t>(m_size)}; }
+    const_iterator begin() const        { return const_iterator{this, 0}; }
+    const_iterator end() const          { return const_iterator{this, static_cast<std::ptrdiff_t>(m_size)}; }
+
+    void clear();
+    void reserve(size_t new_capacity);
+    void resize(size_t new_size, const value_type& row = value_type());
+    void push_back(const value_type& row);
+    void push_back(value_type&& row);
+    template<typename... Args>
+    reference emplace_back(Args&&... fields);
+    void pop_back();
+    void erase(int index);
+    void swap_erase(int index);
+    void shrink_to_fit();
+
+    friend void swap<Ts...>(SoaVector<Ts...>& a, SoaVector<Ts...>& b);
+
+private:
+    using columns = std::tuple<Ts*...>;
+    using indices = std::index_sequence_for<Ts...>;
+    using byte_allocator = AlignedAllocator<unsigned char, COLUMN_ALIGNMENT>;
+    using growth_policy = GeometricGrowth<>;
+
+    static constexpr size_t row_size = (sizeof(Ts) + ...);  // байтове на един ред във всички колони
+
+    template<size_t... I>
+    reference row(size_t i, std::index_sequence<I...>)              { return reference(std::get<I>(m_columns)[i]...); }
+    template<size_t... I>
+    const_reference row(size_t i, std::index_sequence<I...>) const  { return const_reference(std::get<I>(m_columns)[i]...); }
+
+    static size_t column_offset(size_t column, size_t capacity);
+    static columns allocate(size_t capacity);
+    template<size_t... I>
+    static columns carve(unsigned char* block, size_t capacity, std::index_sequence<I...>);
+    static void deallocate(const columns& block, size_t capacity);
+
+    template<typename F>
+    static void for_each_column(F f)                                { for_each_column(f, indices()); }
+    template<typename F, size_t... I>
+    static void for_each_column(F f, std::index_sequence<I...>)     { (f(std::integral_constant<size_t, I>()), ...); }
+
+    template<typename T>
+    static void uninitialized_move(T* begin, T* end, T* dest);
+    template<size_t... I, typename... Args>
+    static void construct_row(const columns& dest, size_t index, std::index_sequence<I...>, Args&&... fields);
+
+    size_t next_capacity(size_t required) const    { return growth_policy::grow(m_capacity, required, row_size); }
+    void relocate(size_t new_capacity);
+    void move_rows(const columns& dest);
+    void destroy_rows(size_t first, size_t last);
+    template<typename... Args>
+    void realloc_emplace_back(Args&&... fields);
+
+    columns m_columns;          // начало на всяка колона в общия блок; първата е в началото му
+    size_t m_capacity;
+    size_t m_size;
+};
+
+/**
+ *  Конструира n реда, всеки копие на row.
+ */
+template<typename... Ts>
+SoaVector<Ts...>::SoaVector(size_t n, const value_type& row)
+    : SoaVector()
+{
+    resize(n, row);
+}
+
+template<typename... Ts>
+SoaVector<Ts...>::SoaVector(std::initializer_list<value_type> rows)
+    : SoaVector()
+{
+    reserve(rows.size());
+    for (const value_type& row : rows)
+    {
+        push_back(row);
+    }
+}
+
+/**
+ *  Копира колона по колона в блок с капацитет точно other.size(). При изключение
+ *  вече копираните колони се унищожават и блокът се освобождава.
+ */
+template<typename... Ts>
+SoaVector<Ts...>::SoaVector(const SoaVector& other)
+    : m_columns(allocate(other.m_size)), m_capacity(other.m_size), m_size(0)
+{
+    size_t copied = 0;
+    try
+    {
+        for_each_column([&](auto column)
+        {
+            std::uninitialized_copy(std::get<column>(other.m_columns), std::get<column>(other.m_columns) + other.m_size,
+                                    std::get<column>(m_columns));
+            ++copied;
+        });
+    }
+    catch (...)
+    {
+        for_each_column([&](auto column)
+        {
+            if (column < copied)
+            {
+                std::destroy(std::get<column>(m_columns), std::get<column>(m_columns) + other.m_size);
+            }
+        });
+        deallocate(m_columns, m_capacity);
+        throw;
+    }
+    m_size = other.m_size;
+}
+
+template<typename... Ts>
+SoaVector<Ts...>& SoaVector<Ts...>::operator=(const SoaVector& other)
+{
+    if (this != &other)
+    {
+        SoaVector temp(other);
+        swap(*this, temp);
+    }
+    return *this;
+}
+
+template<typename... Ts>
+SoaVector<Ts...>::SoaVector(SoaVector&& other) noexcept
+    : m_columns(std::exchange(other.m_columns, columns())),
+      m_capacity(std::exchange(other.m_capacity, 0)),
+      m_size(std::exchange(other.m_size, 0)) {}
+
+template<typename... Ts>
+SoaVector<Ts...>& SoaVector<Ts...>::operator=(SoaVector&& other) noexcept
+{
+    SoaVector temp(std::move(other));
+    swap(*this, temp);
+    return *this;
+}
+
+template<typename... Ts>
+SoaVector<Ts...>::~SoaVector()
+{
+    destroy_rows(0, m_size);
+    deallocate(m_columns, m_capacity);
+}
+
+/**
+ *  Отместване в байтове на колона column от началото на блок с капацитет capacity
+ *  реда. Всяка колона е закръглена до COLUMN_ALIGNMENT, затова отместването на
+ *  колона column_count е размерът на целия блок.
+ */
+template<typename... Ts>
+size_t SoaVector<Ts...>::column_offset(size_t column, size_t capacity)
+{
+    const size_t sizes[] = {sizeof(Ts)...};
+    size_t offset = 0;
+    for (size_t i = 0; i < column; ++i)
+    {
+        offset += (capacity * sizes[i] + COLUMN_ALIGNMENT - 1) & ~(COLUMN_ALIGNMENT - 1);
+    }
+    return offset;
+}
+
+/**
+ *  Заделя общ блок за capacity реда и връща началата на колоните в него.
+ *  При capacity == 0 не се заделя нищо и всички указатели са nullptr.
+ */
+template<typename... Ts>
+typename SoaVector<Ts...>::columns SoaVector<Ts...>::allocate(size_t capacity)
+{
+    if (!capacity)
+    {
+        return columns();
+    }
+    return carve(byte_allocator().allocate(column_offset(column_count, capacity)), capacity, indices());
+}
+
+template<typename... Ts>
+template<size_t... I>
+typename SoaVector<Ts...>::columns SoaVector<Ts...>::carve(unsigned char* block, size_t capacity, std::index_sequence<I...>)
+{
+    return columns(reinterpret_cast<Ts*>(block + column_offset(I, capacity))...);
+}
+
+template<typename... Ts>
+void SoaVector<Ts...>::deallocate(const columns& block, size_t capacity)
+{
+    if (capacity)
+    {
+        byte_allocator().deallocate(reinterpret_cast<unsigned char*>(std::get<0>(block)), column_offset(column_count, capacity));
+    }
+}
+
+/**
+ *  Премества [begin, end) в неинициализираната памет от dest и унищожава оригиналите;
+ *  тривиално преместваемите колони се копират наведнъж с memcpy (виж Vector::uninitialized_move).
+ */
+template<typename... Ts>
+template<typename T>
+void SoaVector<Ts...>::uninitialized_move(T* begin, T* end, T* dest)
+{
+    if constexpr (is_trivially_relocatable<T>::value)
+    {
+        if (begin != end)
+        {
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(begin), (end - begin) * sizeof(T));
+        }
+    }
+    else
+    {
+        for (; begin != end; ++begin, ++dest)
+        {
+            ::new (static_cast<void*>(dest)) T(std::move(*begin));
+            begin->~T();
+        }
+    }
+}
+
+/**
+ *  Конструира ред index в колоните dest, като всяко поле се конструира от съответния
+ *  аргумент. Ако конструкторът на някое поле хвърли, вече конструираните полета на
+ *  реда се унищожават.
+ */
+template<typename... Ts>
+template<size_t... I, typename... Args>
+void SoaVector<Ts...>::construct_row(const columns& dest, size_t index, std::index_sequence<I...>, Args&&... fields)
+{
+    size_t constructed = 0;
+    try
+    {
+        ((::new (static_cast<void*>(std::get<I>(dest) + index)) Ts(std::forward<Args>(fields)), ++constructed), ...);
+    }
+    catch (...)
+    {
+        ((I < constructed ? std::destroy_at(std::get<I>(dest) + index) : void()), ...);
+        throw;
+    }
+}
+
+/**
+ *  Премества всички редове в колоните dest (с достатъчен капацитет).
+ */
+template<typename... Ts>
+void SoaVector<Ts...>::move_rows(const columns& dest)
+{
+    for_each_column([&](auto column)
+    {
+        uninitialized_move(std::get<column>(m_columns), std::get<column>(m_columns) + m_size, std::get<column>(dest));
+    });
+}
+
+template<typename... Ts>
+void SoaVector<Ts...>::destroy_rows(size_t first, size_t last)
+{
+    for_each_column([&](auto column)
+    {
+        std::destroy(std::get<column>(m_columns) + first, std::get<column>(m_columns) + last);
+    });
+}
+
+/**
+ *  Премества редовете в нов блок с капацитет new_capacity (не по-малък от size()).
+ */
+template<typename... Ts>
+void SoaVector<Ts...>::relocate(size_t new_capacity)
+{
+    columns fresh = allocate(new_capacity);
+    move_rows(fresh);
+    deallocate(m_columns, m_capacity);
+    m_columns = fresh;
+    m_capacity = new_capacity;
+}
+
+template<typename... Ts>
+void SoaVector<Ts...>::clear()
+{
+    destroy_rows(0, m_size);
+    m_size = 0;
+}
+
+/**
+ *  Осигурява капацитет поне new_capacity реда във всички колони наведнъж.
+ */
+template<typename... Ts>
+void SoaVector<Ts...>::reserve(size_t new_capacity)
+{
+    if (new_capacity <= m_capacity)
+        return;
+
+    relocate(new_capacity);
+}
+
+/**
+ *  Променя броя на редовете на new_size; новите редове са копия на row.
+ */
+template<typename... Ts>
+void SoaVector<Ts...>::resize(size_t new_size, const value_type& row)
+{
+    if (new_size < m_size)
+    {
+        destroy_rows(new_size, m_size);
+        m_size = new_size;
+        return;
+    }
+
+    reserve(new_size);
+    while (m_size < new_size)
+    {
+        push_back(row);
+    }
+}
+
+template<typename... Ts>
+void SoaVector<Ts...>::push_back(const value_type& row)
+{
+    std::apply([this](const Ts&... fields) { emplace_back(fields...); }, row);
+}
+
+template<typename... Ts>
+void SoaVector<Ts...>::push_back(value_type&& row)
+{
+    std::apply([this](Ts&... fields) { emplace_back(std::move(fields)...); }, row);
+}
+
+/**
+ *  Добавя ред в края, като всяко поле се конструира от съответния аргумент
+ *  (по един аргумент за колона).
+ *
+ *  @param  fields  -   аргументи за конструкторите на полетата, в реда на колоните
+ *  @return референции към полетата на новия ред
+ */
+template<typename... Ts>
+template<typename... Args>
+typename SoaVector<Ts...>::reference SoaVector<Ts...>::emplace_back(Args&&... fields)
+{
+    static_assert(sizeof...(Args) == sizeof...(Ts), "SoaVector: emplace_back takes one argument per column");
+
+    if (m_size == m_capacity)
+    {
+        realloc_emplace_back(std::forward<Args>(fields)...);
+    }
+    else
+    {
+        construct_row(m_columns, m_size, indices(), std::forward<Args>(fields)...);
+        ++m_size;
+    }
+    return back();
+}
+
+/**
+ *  Нарастване при добавяне в края. Аргументите може да сочат към полета на
+ *  вектора, затова новият ред се конструира в новия блок преди старите да бъдат
+ *  преместени (както Vector::realloc_emplace_back).
+ */
+template<typename... Ts>
+template<typename... Args>
+void SoaVector<Ts...>::realloc_emplace_back(Args&&... fields)
+{
+    size_t new_capacity = next_capacity(m_size + 1);
+    columns fresh = allocate(new_capacity);
+    try
+    {
+        construct_row(fresh, m_size, indices(), std::forward<Args>(fields)...);
+    }
+    catch (...)
+    {
+        deallocate(fresh, new_capacity);
+        throw;
+    }
+
+    move_rows(fresh);
+    deallocate(m_columns, m_capacity);
+    m_columns = fresh;
+    m_capacity = new_capacity;
+    ++m_size;
+}
+
+template<typename... Ts>
+void SoaVector<Ts...>::pop_back()
+{
+    destroy_rows(m_size - 1, m_size);
+    --m_size;
+}
+
+/**
+ *  Трие ред index, като следващите редове се изместват с една позиция във всяка колона.
+ */
+template<typename... Ts>
+void SoaVector<Ts...>::erase(int index)
+{
+    for_each_column([&](auto column)
+    {
+        auto* data = std::get<column>(m_columns);
+        std::move(data + index + 1, data + m_size, data + index);
+    });
+    pop_back();
+}
+
+/**
+ *  Трие ред index за O(1), като на мястото му се премества последният ред.
+ *  Редът на останалите редове не се запазва.
+ */
+template<typename... Ts>
+void SoaVector<Ts...>::swap_erase(int index)
+{
+    if (static_cast<size_t>(index) != m_size - 1)
+    {
+        for_each_column([&](auto column)
+        {
+            auto* data = std::get<column>(m_columns);
+            data[index] = std::move(data[m_size - 1]);
+        });
+    }
+    pop_back();
+}
+
+/**
+ *  Смалява общия капацитет според политиката на растеж (GeometricGrowth::shrink).
+ */
+template<typename... Ts>
+void SoaVector<Ts...>::shrink_to_fit()
+{
+    size_t new_capacity = growth_policy::shrink(m_size, m_capacity, row_size);
+    if (new_capacity != m_capacity)
+    {
+        relocate(new_capacity);
+    }
+}
+
+template<typename... Ts>
+void swap(SoaVector<Ts...>& a, SoaVector<Ts...>& b)
+{
+    std::swap(a.m_columns, b.m_columns);
+    std::swap(a.m_capacity, b.m_capacity);
+    std::swap(a.m_size, b.m_size);
+}
+
+#endif // SOAVECTOR_H
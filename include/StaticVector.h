@@ -0,0 +1,379 @@
+#ifndef STATICVECTOR_H
+#define STATICVECTOR_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ *  Памет на StaticVector за тривиални типове: обикновен масив, така че векторът
+ *  е литерален тип и може да се ползва в constexpr контекст. "Конструирането"
+ *  е присвояване, а унищожаването не прави нищо.
+ */
+template<typename T, size_t N, bool = std::is_trivial<T>::value>
+class StaticStorage
+{
+protected:
+    T m_data[N] = {};
+    size_t m_size = 0;
+
+    constexpr T* data()                 { return m_data; }
+    constexpr const T* data() const     { return m_data; }
+
+    template<typename... Args>
+    constexpr void construct(T* p, Args&&... args)
+    {
+        if constexpr (std::is_constructible<T, Args...>::value)
+        {
+            *p = T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            *p = T{std::forward<Args>(args)...};    // агрегати
+        }
+    }
+
+    constexpr void destroy(T*) {}
+};
+
+/**
+ *  Памет на StaticVector за нетривиални типове: неинициализиран подравнен буфер,
+ *  в който елементите се конструират и унищожават явно. Копирането и
+ *  преместването работят поелементно върху първите m_size елемента.
+ */
+template<typename T, size_t N>
+class StaticStorage<T, N, false>
+{
+protected:
+    alignas(T) unsigned char m_buffer[N * sizeof(T)];
+    size_t m_size = 0;
+
+    StaticStorage() {}
+    StaticStorage(const StaticStorage& other)               { append(other.data(), other.data() + other.m_size); }
+    StaticStorage(StaticStorage&& other)                    { append(std::make_move_iterator(other.data()), std::make_move_iterator(other.data() + other.m_size)); }
+    StaticStorage& operator=(const StaticStorage& other);
+    StaticStorage& operator=(StaticStorage&& other);
+    ~StaticStorage()                                        { destroy_all(); }
+
+    T* data()                           { return reinterpret_cast<T*>(m_buffer); }
+    const T* data() const               { return reinterpret_cast<const T*>(m_buffer); }
+
+    template<typename... Args>
+    void construct(T* p, Args&&... args)                    { new(static_cast<void*>(p)) T(std::forward<Args>(args)...); }
+
+    void destroy(T* p)                                      { p->~T(); }
+
+private:
+    template<typename It>
+    void append(It first, It last);
+    void destroy_all();
+};
+
+/**
+ *  Добавя копия на елементите от [first, last) в края. Капацитетът е гарантиран от
+ *  това, че източникът е StaticStorage със същото N.
+ */
+template<typename T, size_t N>
+template<typename It>
+void StaticStorage<T, N, false>::append(It first, It last)
+{
+    for (; first != last; ++first, ++m_size)
+    {
+        construct(data() + m_size, *first);
+    }
+}
+
+template<typename T, size_t N>
+void StaticStorage<T, N, false>::destroy_all()
+{
+    for (; m_size > 0; --m_size)
+    {
+        destroy(data() + m_size - 1);
+    }
+}
+
+template<typename T, size_t N>
+StaticStorage<T, N, false>& StaticStorage<T, N, false>::operator=(const StaticStorage& other)
+{
+    if (this != &other)
+    {
+        destroy_all();
+        append(other.data(), other.data() + other.m_size);
+    }
+    return *this;
+}
+
+template<typename T, size_t N>
+StaticStorage<T, N, false>& StaticStorage<T, N, false>::operator=(StaticStorage&& other)
+{
+    if (this != &other)
+    {
+        destroy_all();
+        append(std::make_move_iterator(other.data()), std::make_move_iterator(other.data() + other.m_size));
+    }
+    return *this;
+}
+
+/**
+ *  Вектор с фиксиран капацитет N, известен по време на компилация. Елементите
+ *  се пазят във вграден масив и векторът никога не заделя динамична памет.
+ *  За тривиални типове всички операции са constexpr, така че таблици могат да
+ *  се построят по време на компилация.
+ *  Препълването е нарушено предусловие, както и индексирането извън размера;
+ *  при Checked == true вместо това се хвърля std::length_error.
+ *  Т - шаблонен тип на елементите, N - капацитет, Checked - проверка за препълване
+ */
+template<typename T, size_t N, bool Checked = false>
+class StaticVector : private StaticStorage<T, N>
+{
+    static_assert(N > 0, "StaticVector needs a capacity of at least one element");
+
+private:
+    using Storage = StaticStorage<T, N>;
+    using Storage::m_size;
+    using Storage::data;
+    using Storage::construct;
+    using Storage::destroy;
+
+public:
+    constexpr StaticVector() = default;
+    constexpr StaticVector(size_t n, const T& val = T())                       { resize(n, val); }
+    constexpr StaticVector(std::initializer_list<T> values);
+
+    constexpr int capacity() const                  { return N; }                       // връща фиксирания капацитет
+    constexpr int size() const                      { return m_size; }                  // връща броят елементи във вектора
+    constexpr bool empty() const                    { return m_size == 0; }             // проверява дали векторът е празен
+    constexpr bool full() const                     { return m_size == N; }             // проверява дали капацитетът е изчерпан
+    constexpr T& operator[](int i)                  { return data()[i]; }               // дава read-write достъп до i-я елемент
+    constexpr const T& operator[](int i) const      { return data()[i]; }               // дава read-only достъп до i-я елемент
+    constexpr T& back()                             { return data()[m_size - 1]; }      // дава референция към последния елемент
+    constexpr const T& back() const                 { return data()[m_size - 1]; }
+    constexpr T& front()                            { return data()[0]; }               // дава референция към първия елемент
+    constexpr const T& front() const                { return data()[0]; }
+
+    constexpr void clear();
+    constexpr void resize(size_t new_size, const T& val = T());
+    constexpr void push_back(const T& val)          { emplace_back(val); }
+    constexpr void push_back(T&& val)               { emplace_back(std::move(val)); }
+    template<typename... Args>
+    constexpr T& emplace_back(Args&&... args);
+    template<typename... Args>
+    constexpr T& emplace(int index, Args&&... args);
+    constexpr void pop_back();
+    constexpr void insert(int index, const T& value)    { emplace(index, value); }
+    constexpr void insert(int index, T&& value)         { emplace(index, std::move(value)); }
+    constexpr void insert(int index, size_t count, const T& value);
+    constexpr void erase(int index)                     { erase(index, index + 1); }
+    constexpr void erase(int first, int last);
+    constexpr void swap_erase(int index);
+
+private:
+    constexpr void check_capacity(size_t needed) const;
+};
+
+/**
+ *  Проверка за препълване, която има ефект само при Checked == true.
+ *
+ *  @param  needed  -   брой елементи, които трябва да се поберат във вектора
+ */
+template<typename T, size_t N, bool Checked>
+constexpr void StaticVector<T, N, Checked>::check_capacity(size_t needed) const
+{
+    if constexpr (Checked)
+    {
+        if (needed > N)
+        {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+}
+
+template<typename T, size_t N, bool Checked>
+constexpr StaticVector<T, N, Checked>::StaticVector(std::initializer_list<T> values)
+{
+    check_capacity(values.size());
+    for (const T& value : values)
+    {
+        construct(data() + m_size, value);
+        ++m_size;
+    }
+}
+
+/**
+ *  Процедура за унищожаване на всички елементи на вектора.
+ */
+template<typename T, size_t N, bool Checked>
+constexpr void StaticVector<T, N, Checked>::clear()
+{
+    for (; m_size > 0; --m_size)
+    {
+        destroy(data() + m_size - 1);
+    }
+}
+
+/**
+ *  Оразмерява вектора: нови елементи се конструират по образа на val,
+ *  а излишните се унищожават.
+ *
+ *  @param  new_size    -   нов брой на елементите, не повече от N
+ *  @param  val         -   стойност, с която да се инициализират новодобавените елементи
+ */
+template<typename T, size_t N, bool Checked>
+constexpr void StaticVector<T, N, Checked>::resize(size_t new_size, const T& val)
+{
+    check_capacity(new_size);
+    for (; m_size < new_size; ++m_size)
+    {
+        construct(data() + m_size, val);
+    }
+    for (; m_size > new_size; --m_size)
+    {
+        destroy(data() + m_size - 1);
+    }
+}
+
+/**
+ *  Конструира нов елемент в края на вектора от подадените аргументи.
+ *
+ *  @return референция към новия елемент
+ */
+template<typename T, size_t N, bool Checked>
+template<typename... Args>
+constexpr T& StaticVector<T, N, Checked>::emplace_back(Args&&... args)
+{
+    check_capacity(m_size + 1);
+    construct(data() + m_size, std::forward<Args>(args)...);
+    ++m_size;
+    return back();
+}
+
+/**
+ *  Конструира нов елемент на позиция index. Новият елемент първо се конструира
+ *  във временен обект, защото аргументите може да сочат към елемент, който ще
+ *  бъде изместен, а елементите вдясно се изместват с една позиция.
+ *
+ *  @return референция към новия елемент
+ */
+template<typename T, size_t N, bool Checked>
+template<typename... Args>
+constexpr T& StaticVector<T, N, Checked>::emplace(int index, Args&&... args)
+{
+    if (static_cast<size_t>(index) == m_size)
+    {
+        return emplace_back(std::forward<Args>(args)...);
+    }
+
+    check_capacity(m_size + 1);
+    T value(std::forward<Args>(args)...);
+
+    T* items = data();
+    construct(items + m_size, std::move(items[m_size - 1]));
+    for (size_t i = m_size - 1; i > static_cast<size_t>(index); --i)
+    {
+        items[i] = std::move(items[i - 1]);
+    }
+    ++m_size;
+
+    items[index] = std::move(value);
+    return items[index];
+}
+
+/**
+ *  Вмъква count копия на value от позиция index, като опашката се измества
+ *  наведнъж с count позиции.
+ */
+template<typename T, size_t N, bool Checked>
+constexpr void StaticVector<T, N, Checked>::insert(int index, size_t count, const T& value)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    check_capacity(m_size + count);
+    const T copy(value);
+    T* items = data();
+
+    // елементите, които минават след стария край, се конструират, останалите се присвояват
+    for (size_t i = m_size + count; i-- > static_cast<size_t>(index) + count; )
+    {
+        if (i >= m_size)
+        {
+            construct(items + i, std::move(items[i - count]));
+        }
+        else
+        {
+            items[i] = std::move(items[i - count]);
+        }
+    }
+    for (size_t i = index; i < index + count; ++i)
+    {
+        if (i >= m_size)
+        {
+            construct(items + i, copy);
+        }
+        else
+        {
+            items[i] = copy;
+        }
+    }
+
+    m_size += count;
+}
+
+/**
+ *  pop_back() унищожава последният елемент във вектора, ако има такъв.
+ */
+template<typename T, size_t N, bool Checked>
+constexpr void StaticVector<T, N, Checked>::pop_back()
+{
+    if (!empty())
+    {
+        --m_size;
+        destroy(data() + m_size);
+    }
+}
+
+/**
+ *  Трие елементите в интервала [first, last) с едно изместване на опашката
+ *  и унищожава само останалите в края преместени обекти.
+ */
+template<typename T, size_t N, bool Checked>
+constexpr void StaticVector<T, N, Checked>::erase(int first, int last)
+{
+    if (first == last)
+    {
+        return;
+    }
+
+    T* items = data();
+    size_t dest = first;
+    for (size_t src = last; src < m_size; ++src, ++dest)
+    {
+        items[dest] = std::move(items[src]);
+    }
+    for (; m_size > dest; --m_size)
+    {
+        destroy(items + m_size - 1);
+    }
+}
+
+/**
+ *  Трие елемента на позиция index за константно време, като на мястото му
+ *  се премества последният елемент.
+ */
+template<typename T, size_t N, bool Checked>
+constexpr void StaticVector<T, N, Checked>::swap_erase(int index)
+{
+    T* items = data();
+    if (static_cast<size_t>(index) != m_size - 1)
+    {
+        items[index] = std::move(items[m_size - 1]);
+    }
+    pop_back();
+}
+
+#endif // STATICVECTOR_H
@@ -0,0 +1,363 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *  Пул от нишки с крадене на задачи (work stealing), върху който работят
+ *  паралелните алгоритми от VectorParallel.h: parallel_copy, parallel_resize,
+ *  parallel_for, parallel_transform и parallel_sort.
+ *
+ *  Всяка работна нишка има своя опашка: нишката взима задачи от края ѝ, а когато
+ *  остане без работа, краде от началото на опашките на другите. Задачите на run()
+ *  се разпределят по опашките последователно, а извикващата нишка не чака бездейно,
+ *  а също изпълнява задачи, докато всички приключат. Затова run() може да се вика
+ *  и от задача на същия пул (напр. рекурсивно при parallel_sort), без да блокира.
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned workers = default_worker_count());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    unsigned worker_count() const       { return static_cast<unsigned>(m_queues.size()); }     // брой фонови нишки
+    unsigned concurrency() const        { return worker_count() + 1; }                          // нишки, заедно с извикващата
+
+    template<typename F>
+    void run(size_t tasks, F&& f);
+
+    static unsigned default_worker_count();
+
+private:
+    using Task = std::function<void()>;
+
+    /**
+     *  Опашка на една работна нишка. Пази се с mutex: задачите са едри
+     *  (парчета от вектор), така че цената на заключването е пренебрежима.
+     */
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(size_t queue, Task task);
+    bool pop_local(Task& task);
+    bool steal(Task& task, size_t start);
+    bool try_run_one();
+    void worker_loop(size_t index);
+
+    std::vector<std::unique_ptr<WorkQueue> > m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::atomic<size_t> m_queued{0};    // задачи, които чакат в опашките
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep;
+    bool m_stop = false;
+
+    // пулът на текущата нишка (nullptr извън пуловете) и индексът на опашката ѝ
+    static inline thread_local ThreadPool* t_pool = nullptr;
+    static inline thread_local size_t t_index = 0;
+};
+
+/**
+ *  По подразбиране: една нишка по-малко от хардуерните, защото извикващата
+ *  нишка също изпълнява задачи.
+ */
+inline unsigned ThreadPool::default_worker_count()
+{
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+/**
+ *  Стартира работните нишки.
+ *
+ *  @param  workers -   брой фонови нишки; при 0 run() изпълнява всичко в извикващата нишка
+ */
+inline ThreadPool::ThreadPool(unsigned workers)
+{
+    for (unsigned i = 0; i < workers; ++i)
+    {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned i = 0; i < workers; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+/**
+ *  Изчаква текущите задачи и спира работните нишки.
+ */
+inline ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stop = true;
+    }
+    m_sleep.notify_all();
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+/**
+ *  Изпълнява f(task) за всяко task в [0, tasks) и се връща, когато всички приключат.
+ *  Ако някоя задача хвърли изключение, останалите се изпълняват докрай, а първото
+ *  изключение се хвърля отново в извикващата нишка.
+ *
+ *  @param  tasks   -   брой задачи
+ *  @param  f       -   функция, която приема индекса на задачата
+ */
+template<typename F>
+void ThreadPool::run(size_t tasks, F&& f)
+{
+    if (tasks == 0)
+    {
+        return;
+    }
+    if (tasks == 1 || m_queues.empty())
+    {
+        for (size_t task = 0; task < tasks; ++task)
+        {
+            f(task);
+        }
+        return;
+    }
+
+    std::atomic<size_t> remaining{tasks};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    // задача 0 се изпълнява директно от извикващата нишка, останалите отиват в опашките
+    auto execute = [&](size_t task)
+    {
+        try
+        {
+            f(task);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+    };
+
+    size_t first_queue = t_pool == this ? t_index : 0;
+    for (size_t task = 1; task < tasks; ++task)
+    {
+        push((first_queue + task) % m_queues.size(), [&execute, task]() { execute(task); });
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    }
+    m_sleep.notify_all();
+
+    execute(0);
+    while (remaining.load(std::memory_order_acquire) != 0)
+    {
+        if (!try_run_one())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+inline void ThreadPool::push(size_t queue, Task task)
+{
+    std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+    m_queues[queue]->tasks.push_back(std::move(task));
+    m_queued.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ *  Взима последната задача от опашката на текущата нишка (най-топлата в кеша).
+ */
+inline bool ThreadPool::pop_local(Task& task)
+{
+    if (t_pool != this)
+    {
+        return false;
+    }
+
+    WorkQueue& queue = *m_queues[t_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ *  Краде най-старата задача от първата непразна опашка, започвайки от start.
+ */
+inline bool ThreadPool::steal(Task& task, size_t start)
+{
+    for (size_t i = 0; i < m_queues.size(); ++i)
+    {
+        WorkQueue& queue = *m_queues[(start + i) % m_queues.size()];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty())
+        {
+            continue;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        m_queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+inline bool ThreadPool::try_run_one()
+{
+    Task task;
+    if (pop_local(task) || steal(task, t_pool == this ? t_index + 1 : 0))
+    {
+        task();
+        return true;
+    }
+    return false;
+}
+
+inline void ThreadPool::worker_loop(size_t index)
+{
+    t_pool = this;
+    t_index = index;
+
+    for (;;)
+    {
+        if (try_run_one())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_sleep.wait(lock, [this]() { return m_stop || m_queued.load(std::memory_order_acquire) != 0; });
+        if (m_stop && m_queued.load(std::memory_order_acquire) == 0)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ *  Пулът по подразбиране за паралелните операции. Създава се при първото използване
+ *  с set_default_thread_pool_workers() нишки или ThreadPool::default_worker_count().
+ */
+inline std::atomic<unsigned>& default_thread_pool_workers()
+{
+    static std::atomic<unsigned> workers{ThreadPool::default_worker_count()};
+    return workers;
+}
+
+inline ThreadPool& default_thread_pool()
+{
+    static ThreadPool pool(default_thread_pool_workers().load());
+    return pool;
+}
+
+/**
+ *  Задава броя фонови нишки на пула по подразбиране. Има ефект само преди първото
+ *  извикване на default_thread_pool(); за друг брой нишки по-късно създайте свой ThreadPool.
+ */
+inline void set_default_thread_pool_workers(unsigned workers)
+{
+    default_thread_pool_workers().store(workers);
+}
+
+/**
+ *  Маркер за паралелните алгоритми от VectorParallel.h; указва пула, в който се изпълняват:
+ *
+ *      Vector<double> copy = parallel_copy(big, parallel);
+ *      parallel_resize(big, n, 0.0, ParallelExecution{&pool});
+ */
+struct ParallelExecution
+{
+    ThreadPool* pool = nullptr;         // nullptr - пулът по подразбиране
+
+    ThreadPool& get_pool() const        { return pool ? *pool : default_thread_pool(); }
+};
+
+constexpr ParallelExecution parallel{};
+
+/**
+ *  Най-малкото парче, за което си струва отделна задача, и размер на кеш линия.
+ */
+constexpr size_t parallel_min_chunk_bytes = 64 * 1024;
+constexpr size_t parallel_cache_line = 64;
+
+/**
+ *  Брой парчета, на които parallel_chunks разделя n елемента с размер element_size:
+ *  около 4 на нишка, но не по-малки от parallel_min_chunk_bytes.
+ */
+inline size_t parallel_chunk_count(const ThreadPool& pool, size_t n, size_t element_size)
+{
+    size_t chunks = std::min<size_t>(pool.concurrency() * 4, n * element_size / parallel_min_chunk_bytes);
+    return chunks ? chunks : 1;
+}
+
+/**
+ *  Разделя [first, first + n) на parallel_chunk_count парчета и извиква f(begin, end, chunk)
+ *  за всяко от тях в пула. Границите между парчетата са на адреси, кратни на кеш линия,
+ *  за да не пишат две нишки в една и съща линия. Малките масиви са едно парче и се
+ *  обработват в извикващата нишка.
+ *
+ *  @param  pool    -   пул, в който да се изпълнят парчетата
+ *  @param  first   -   начало на масива
+ *  @param  n       -   брой елементи
+ *  @param  f       -   функция f(T* begin, T* end, size_t chunk); някои парчета може да са празни
+ */
+template<typename T, typename F>
+void parallel_chunks(ThreadPool& pool, T* first, size_t n, F&& f)
+{
+    const size_t chunks = parallel_chunk_count(pool, n, sizeof(T));
+    const size_t step = n / chunks;
+
+    // граница i е на i * step, закръглена нагоре до адрес, кратен на кеш линия
+    auto boundary = [first, n, chunks, step](size_t i) -> size_t
+    {
+        if (i == 0 || i == chunks)
+        {
+            return i == 0 ? 0 : n;
+        }
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(first + i * step);
+        std::uintptr_t aligned = (address + parallel_cache_line - 1) & ~(std::uintptr_t(parallel_cache_line) - 1);
+        return std::min(i * step + (aligned - address + sizeof(T) - 1) / sizeof(T), n);
+    };
+
+    pool.run(chunks, [&](size_t chunk)
+    {
+        size_t begin = boundary(chunk), end = boundary(chunk + 1);
+        f(first + begin, first + std::max(begin, end), chunk);
+    });
+}
+
+#endif // THREADPOOL_H
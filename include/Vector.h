@@ -2,36 +2,58 @@
 #define VECTOR_H
 
 #include "VectorBase.h"
+#include "VectorTraits.h"
+#include "GrowthPolicy.h"
+#include "VectorStats.h"
+#include <cassert>
 #include <memory>
-#include <cmath>
-
-template<typename T, typename A>
+#include <memory_resource>
+#include <cstring>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <type_traits>
+
+template<typename T, typename A, typename G>
 class Vector;
 
-template<typename T, typename A>
-void swap(Vector<T, A>& a, Vector<T, A>& b);    // тривиална swap функция за вектора
+template<typename T, typename A, typename G>
+void swap(Vector<T, A, G>& a, Vector<T, A, G>& b);    // тривиална swap функция за вектора
+
+template<typename T, typename A, typename G, typename U>
+size_t erase(Vector<T, A, G>& vec, const U& value);    // трие всички елементи, равни на value
+
+template<typename T, typename A, typename G, typename Pred>
+size_t erase_if(Vector<T, A, G>& vec, Pred pred);      // трие всички елементи, за които pred е истина
 
 /**
  *  Вектор, композиран от помощния вектор VectorBase, за да използва RAII техниката
- *  Т - шаблонен тип на елементите във вектора, А - шаблонен тип на алокатора
+ *  Т - шаблонен тип на елементите във вектора, А - шаблонен тип на алокатора,
+ *  G - политика на растеж (виж GrowthPolicy.h)
  */
-template<typename T, typename A = std::allocator<T> >
+template<typename T, typename A = std::allocator<T>, typename G = GeometricGrowth<> >
 class Vector
 {
-private:
-    VectorBase<T> base;             // композиция, RAII
+protected:
+    using alloc_traits = std::allocator_traits<A>;
+
+    VectorBase<T, A> base;          // композиция, RAII; достъпен за производните вектори (SmallVector)
 
-    static const int INITIAL_SIZE = 4;              // начален размер на вектор, в случай че е бил празен
-    static constexpr double GROWTH_RATE = 1.5;      // множител на нарастване на вектора
+#ifdef VECTOR_ENABLE_STATS
+    VectorStats m_stats;            // статистика на този вектор, виж VectorStats.h
+#endif
 
 public:
     Vector() : base(A(), 0) {}                                                  // конструктор по подразбиране, създава вектор с размер 0
+    explicit Vector(const A& alloc) : base(alloc, 0) {}                         // празен вектор, който ползва подадения алокатор
     Vector(size_t n, const T& val = T(), const A& alloc = A());
     Vector(const Vector& other);
+    Vector(const Vector& other, const A& alloc);
     Vector& operator=(const Vector& other);
     Vector(Vector&& other);
     Vector& operator=(Vector&& other);
-    ~Vector()                           { clear(); }                            // дестуктор, който се грижи да унищожи елементите на вектора
+    ~Vector();
 
     int capacity() const                { return base.last - base.first; }      // връща капацитета на вектора
     int size() const                    { return base.space - base.first; }     // връща броят елементи във вектора
@@ -40,66 +62,186 @@ public:
     const T& operator[](int i) const    { return *(base.first + i); }           // дава read-only дотъп до i-я елемент на вектора
     T& back()                           { return *(base.space - 1); }           // дава референция към последния елемент
     T& front()                          { return *(base.first); }               // дава референция към първия елемент
+    T* data()                           { return base.first; }                  // указател към непрекъснатия масив от елементи
+    const T* data() const               { return base.first; }                  // read-only указател към масива от елементи
+    A get_allocator() const             { return base.alloc; }                  // връща копие на алокатора на вектора
+#ifdef VECTOR_ENABLE_STATS
+    const VectorStats& stats() const    { return m_stats; }                     // статистика на този вектор
+#endif
 
     void clear();
     void reserve(size_t new_size);
     void resize(size_t new_size, const T& val = T());
+    T* append_uninitialized(size_t count);
     void push_back(const T& val);
+    void push_back(T&& val);
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
+    template<typename... Args>
+    T& emplace(int index, Args&&... args);
     void pop_back();
     void insert(int index, const T& value);
+    void insert(int index, T&& value);
+    void insert(int index, size_t count, const T& value);
+    void insert(int index, std::initializer_list<T> values);
+    template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+    void insert(int index, InputIt first, InputIt last);
     void erase(int index);
+    void erase(int first, int last);
+    void swap_erase(int index);
+    template<typename U>
+    size_t remove(const U& value);
+    template<typename Pred>
+    size_t remove_if(Pred pred);
     void shrink_to_fit();
 
-    friend void swap<T, A>(Vector<T, A>& a, Vector<T, A>& b);
+    friend void swap<T, A, G>(Vector<T, A, G>& a, Vector<T, A, G>& b);
 
 private:
 
+    size_t next_capacity(size_t required) const;
+    void relocate(size_t new_capacity);
+    void note_relocation(size_t old_capacity, size_t moved);
+
+    template<typename... Args>
+    void realloc_emplace_back(Args&&... args);
+
+    template<typename... Args>
+    void realloc_emplace(int index, Args&&... args);
+
+    template<typename ForwardIt>
+    void insert_range(int index, ForwardIt first, ForwardIt last, size_t n);
+
+    /**
+     *  Помощен итератор, който връща една и съща стойност count пъти.
+     *  Използва се, за да сведем insert(index, count, value) до insert_range.
+     */
+    struct repeat_iterator
+    {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const T*;
+        using reference         = const T&;
+
+        const T* value;
+        difference_type count;
+
+        reference operator*() const                             { return *value; }
+        pointer operator->() const                              { return value; }
+        repeat_iterator& operator++()                           { ++count; return *this; }
+        repeat_iterator operator++(int)                         { repeat_iterator old = *this; ++count; return old; }
+        bool operator==(const repeat_iterator& other) const     { return count == other.count; }
+        bool operator!=(const repeat_iterator& other) const     { return count != other.count; }
+    };
+
     /**
      *  Помощна функция за преместващо копиране на интервал [begin, end) в интервал,
      *  започващ с dest включително. След изпълнението на функцията, елементите
      *  от интервала [begin, end) ще са унищожени.
+     *  За тривиално преместваеми типове целият интервал се копира с един memcpy.
      *
      *  @param  begin   - указател към първия елемент, който да се копира (включително)
      *  @param  end     - указател към последния елемент, който да се копира (изключващо)
      *  @param  dest    - маркира началото на предназначеното място, където да се копират елементите
      */
-    static void uninitialized_move(T* begin, T* end, T* dest)
+    void uninitialized_move(T* begin, T* end, T* dest)
     {
-        for(;begin != end; ++begin, ++dest)
+        if constexpr (is_trivially_relocatable<T>::value)
         {
-            new(static_cast<void*>(dest)) T(std::move(*begin));  // форсираме конструктора за преместващо копиране
-            begin->~T();
+            if (begin != end)
+            {
+                std::memcpy(static_cast<void*>(dest), static_cast<const void*>(begin), (end - begin) * sizeof(T));
+            }
+        }
+        else
+        {
+            for(;begin != end; ++begin, ++dest)
+            {
+                alloc_traits::construct(base.alloc, dest, std::move(*begin));  // форсираме конструктора за преместващо копиране
+                alloc_traits::destroy(base.alloc, begin);
+            }
         }
     }
 
     /**
-     *  Помощна функция за унищожаване на елементите в интервал [begin, end)
+     *  Помощна функция за копиране на интервала [first, last) в неинициализирана памет,
+     *  започваща от dest, като елементите се конструират чрез алокатора. При изключение
+     *  вече конструираните елементи се унищожават. Когато алокаторът не добавя нищо
+     *  към конструирането (is_plain_allocator), се ползва std::uninitialized_copy.
      *
-     *  @param  begin   - указател към първия елемент, който да се унищожи (включително)
-     *  @param  end     - указател към последния елемент, който да се унищожи (изключващо)
+     *  @return указател след последния конструиран елемент
      */
-    static void destroy_range(T* begin, T* end) // destroy [begin, end)
+    template<typename InputIt>
+    T* uninitialized_copy_a(InputIt first, InputIt last, T* dest)
     {
-        for(;begin != end; ++begin)
+        if constexpr (is_plain_allocator<A>::value)
+        {
+            T* end = std::uninitialized_copy(first, last, dest);
+            VECTOR_STATS_HOOK(m_stats.constructions += end - dest);
+            return end;
+        }
+        else
         {
-            begin->~T();
+            T* cursor = dest;
+            try
+            {
+                for (; first != last; ++first, ++cursor)
+                {
+                    alloc_traits::construct(base.alloc, cursor, *first);
+                }
+            }
+            catch (...)
+            {
+                destroy_range(dest, cursor);
+                throw;
+            }
+            VECTOR_STATS_HOOK(m_stats.constructions += cursor - dest);
+            return cursor;
         }
     }
 
     /**
-     *  Помощна функция, приемаща интервала [begin, end), която премества end наляво
-     *  до позиция begin чрез последователни разменяния на директните съседни елементи.
-     *  Функцията се използва за реализиране на insert метода.
+     *  Помощна функция, която конструира копия на val в неинициализирания интервал
+     *  [begin, end) чрез алокатора. Аналог на std::uninitialized_fill.
+     */
+    void uninitialized_fill_a(T* begin, T* end, const T& val)
+    {
+        VECTOR_STATS_HOOK(m_stats.constructions += end - begin);
+        if constexpr (is_plain_allocator<A>::value)
+        {
+            std::uninitialized_fill(begin, end, val);
+        }
+        else
+        {
+            T* cursor = begin;
+            try
+            {
+                for (; cursor != end; ++cursor)
+                {
+                    alloc_traits::construct(base.alloc, cursor, val);
+                }
+            }
+            catch (...)
+            {
+                destroy_range(begin, cursor);
+                throw;
+            }
+        }
+    }
+
+    /**
+     *  Помощна функция за унищожаване на елементите в интервал [begin, end)
      *
-     *  @param  begin   - указател към първия елемент от интервала (включително)
-     *  @param  end     - указател към последния елемент от интервала (изключващо)
+     *  @param  begin   - указател към първия елемент, който да се унищожи (включително)
+     *  @param  end     - указател към последния елемент, който да се унищожи (изключващо)
      */
-    static void swap_range_backwards(T* begin, T* end)
+    void destroy_range(T* begin, T* end) // destroy [begin, end)
     {
-        T* left = end - 1;
-        while(end != begin)
+        VECTOR_STATS_HOOK(m_stats.on_size(size()); m_stats.destructions += end - begin);
+        for(;begin != end; ++begin)
         {
-            std::swap(*(left--), *(end--));
+            alloc_traits::destroy(base.alloc, begin);
         }
     }
 
@@ -114,68 +256,113 @@ private:
  *  @param  val     - стойност, с която да бъдат инициализирани елементите
  *  @param  alloc   - алокатор, който да се грижи за управлението на паметта
  */
-template<typename T, typename A>
-Vector<T, A>::Vector(size_t count, const T& val, const A& alloc)
+template<typename T, typename A, typename G>
+Vector<T, A, G>::Vector(size_t count, const T& val, const A& alloc)
     : base(alloc, count)
 {
-    std::uninitialized_fill(base.first, base.first + count, val);
+    uninitialized_fill_a(base.first, base.first + count, val);
+    VECTOR_STATS_HOOK(note_relocation(0, 0));
 }
 
 /**
- *  Тривиален копиращ конструктор, който използва std::uninitialized_copy,
- *  за да копира всички елементи от подадения вектор в *this.
+ *  Тривиален копиращ конструктор, който копира всички елементи от подадения вектор
+ *  в *this. Алокаторът се взима така, както го избере
+ *  select_on_container_copy_construction.
+ */
+template<typename T, typename A, typename G>
+Vector<T, A, G>::Vector(const Vector& other)
+    : Vector(other, alloc_traits::select_on_container_copy_construction(other.base.alloc))
+{}
+
+/**
+ *  Копиращ конструктор, който заделя паметта на копието чрез подадения алокатор.
  */
-template<typename T, typename A>
-Vector<T, A>::Vector(const Vector& other)
-    : base(other.base.alloc, other.size())
+template<typename T, typename A, typename G>
+Vector<T, A, G>::Vector(const Vector& other, const A& alloc)
+    : base(alloc, other.size())
 {
-    std::uninitialized_copy(other.base.first, other.base.space, base.first);
+    uninitialized_copy_a(other.base.first, other.base.space, base.first);
+    VECTOR_STATS_HOOK(note_relocation(0, 0));
 }
 
 /**
  *  Оператор за копиращo присвояване, който използва copy-and-swap идиома.
- *  Преизползва се копиращият конструктор, за да се построи временен обект
- *  (копие на подадения аргумент), чието съдържание се разменя със *this.
- *  *this вече е копие на аргумента, а на старото съдържание, което вече е
- *  в temp, се извиква неявно деструкторът. Strong exception safety.
+ *  Построява се временно копие на подадения аргумент с алокатора, който *this
+ *  трябва да има след присвояването (този на other, ако алокаторът се разпространява
+ *  при копиране, иначе собственият), и съдържанието му се разменя със *this.
+ *  На старото съдържание, което вече е в temp, се извиква неявно деструкторът.
+ *  Strong exception safety.
  */
-template<typename T, typename A>
-Vector<T, A>& Vector<T, A>::operator=(const Vector& other)
+template<typename T, typename A, typename G>
+Vector<T, A, G>& Vector<T, A, G>::operator=(const Vector& other)
 {
-    Vector<T, A> temp(other);
-    std::swap(*this, temp);
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    Vector<T, A, G> temp(other, alloc_traits::propagate_on_container_copy_assignment::value
+                                ? other.base.alloc : base.alloc);
+    base = std::move(temp.base);
     return *this;
 }
 
 /**
  *  Тривиален преместващ конструктор.
  */
-template<typename T, typename A>
-Vector<T, A>::Vector(Vector&& other)
+template<typename T, typename A, typename G>
+Vector<T, A, G>::Vector(Vector&& other)
     : base(std::move(other.base))
 {}
 
 /**
- *  Тривиален оператор за преместващо присвояване.
+ *  Оператор за преместващо присвояване. Ако алокаторът се разпространява при
+ *  преместване или двата алокатора са равни, буферът на other се открадва.
+ *  В противен случай паметта на other не може да бъде освободена от нашия
+ *  алокатор, затова елементите се преместват един по един.
  */
-template<typename T, typename A>
-Vector<T, A>& Vector<T, A>::operator=(Vector&& other)
+template<typename T, typename A, typename G>
+Vector<T, A, G>& Vector<T, A, G>::operator=(Vector&& other)
 {
+    if (this == &other)
+    {
+        return *this;
+    }
+
     clear();
-    base = std::move(other.base);
+    if (alloc_traits::propagate_on_container_move_assignment::value || base.alloc == other.base.alloc)
+    {
+        base = std::move(other.base);
+    }
+    else
+    {
+        reserve(other.size());
+        uninitialized_copy_a(std::make_move_iterator(other.base.first),
+                             std::make_move_iterator(other.base.space), base.first);
+        base.space = base.first + other.size();
+        other.clear();
+    }
     return *this;
 }
 
+/**
+ *  Деструктор, който се грижи да унищожи елементите на вектора и,
+ *  ако е включено инструментирането, да отчете статистиката му.
+ */
+template<typename T, typename A, typename G>
+Vector<T, A, G>::~Vector()
+{
+    clear();
+    VECTOR_STATS_HOOK(if (capacity()) ++m_stats.deallocations; report_vector_stats<T>(m_stats));
+}
+
 /**
  *  Процедура за унищожаване на всички елементи на вектора.
  */
-template<typename T, typename A>
-void Vector<T, A>::clear()
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::clear()
 {
-    for (T* cursor = base.first; cursor != base.space; ++cursor)
-    {
-        cursor->~T();
-    }
+    destroy_range(base.first, base.space);
     base.space = base.first;        // краят на елементите съвпада с началото
 }
 
@@ -183,19 +370,72 @@ void Vector<T, A>::clear()
  *  Ако new_capacity <= моментния капацитет, функцията приключва.
  *  В противен случай създава нов помощен вектор, в който премества всички елементи
  *  на this->base, разменя новия помощен вектор със this->base, който вече е празен и
- *  съответно му се извиква деструктора.
+ *  съответно му се извиква деструктора (виж relocate).
  *
  *  @param  new_capacity    -   естествено число, нов капацитет на вектора
  */
-template<typename T, typename A>
-void Vector<T, A>::reserve(size_t new_capacity)
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::reserve(size_t new_capacity)
 {
-    if (new_capacity <= capacity())
+    if (new_capacity <= static_cast<size_t>(capacity()))
         return;
 
-    VectorBase<T, A> temp(base.alloc, size(), new_capacity - size());
-    uninitialized_move(base.first, base.first + size(), temp.first);
-    std::swap(base, temp);
+    relocate(new_capacity);
+}
+
+/**
+ *  Премества елементите в буфер с капацитет new_capacity (не по-малък от size()),
+ *  чрез realloc, ако паметта може да расте на място, или чрез нов помощен вектор.
+ *
+ *  @param  new_capacity    -   нов капацитет на вектора
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::relocate(size_t new_capacity)
+{
+    VECTOR_STATS_HOOK(size_t old_capacity = capacity());
+
+    if constexpr (decltype(base)::reallocatable)
+    {
+        base.reallocate(new_capacity);
+    }
+    else
+    {
+        VectorBase<T, A> temp(base.alloc, size(), new_capacity - size());
+        uninitialized_move(base.first, base.first + size(), temp.first);
+        std::swap(base, temp);
+    }
+
+    VECTOR_STATS_HOOK(note_relocation(old_capacity, size()));
+}
+
+/**
+ *  Отчита в статистиката, че векторът е получил нов буфер с капацитет capacity(),
+ *  в който са преместени moved елемента. Извиква се само чрез VECTOR_STATS_HOOK.
+ *
+ *  @param  old_capacity    -   капацитет преди преразпределянето, 0 ако не е имало буфер
+ *  @param  moved           -   брой преместени елементи
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::note_relocation(size_t old_capacity, size_t moved)
+{
+#ifdef VECTOR_ENABLE_STATS
+    if (old_capacity && capacity())
+    {
+        m_stats.on_reallocate(capacity(), moved, sizeof(T));
+    }
+    else if (old_capacity)
+    {
+        ++m_stats.deallocations;
+    }
+    else if (capacity())
+    {
+        m_stats.on_allocate(capacity(), sizeof(T));
+    }
+    m_stats.on_size(size());
+#else
+    (void)old_capacity;
+    (void)moved;
+#endif
 }
 
 /**
@@ -203,20 +443,20 @@ void Vector<T, A>::reserve(size_t new_capacity)
  *  Използва reserve, за да подсигури нужния капацитет. Ако новият размер на вектора
  *  е по-голям от предишния (вектора е уголемен), свободният капацитет се допълва с
  *  елементи, конструирани по образа на val. В противен случай, когато векторът е смален,
- *  излишните елементи се унищожават. Накрая space = last, защото капацитетът е запълнен.
+ *  излишните елементи се унищожават. Капацитетът остава непроменен.
  *
  *  @param  new_size    -   естествено число, нов брой на елементите на вектора
  *  @param  val         -   стойност, с която да се инициализират новодобавените елементи
  */
-template<class T, class A>
-void Vector<T,A>::resize(size_t new_size, const T& val)
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::resize(size_t new_size, const T& val)
 {
     reserve(new_size);
 
-    if (size() < new_size)
+    if (static_cast<size_t>(size()) < new_size)
     {
         // конструирай нови елементи в интервала: [size(), new_size)
-        std::uninitialized_fill(base.first + size(), base.first + new_size, val);
+        uninitialized_fill_a(base.first + size(), base.first + new_size, val);
     }
     else
     {
@@ -224,110 +464,539 @@ void Vector<T,A>::resize(size_t new_size, const T& val)
         destroy_range(base.first + new_size, base.first + size());
     }
 
-    base.space = base.last = base.first + new_size;
+    base.space = base.first + new_size;
 }
 
 /**
- *  push_back се грижи за добавяне на нов елемент към вектора в задния край.
- *  В случай, че капацитета е изчерпан се заделя допълнителен капацитет, който
- *  се определя от множителя на растене GROWTH_RATE. Ако векторът е бил празен,
- *  се заделя INITIAL_SIZE капацитет. Новият елемент се конструира от алокатора.
- *  Накрая се увеличава указателят, който маркира новия край на елементите.
+ *  Добавя count неинициализирани елемента в края на вектора и връща указател към
+ *  първия от тях. Само за тривиално копируеми типове: извикващият трябва да запише
+ *  байтовете на всичките count елемента (напр. с read или memcpy), преди да ги чете. Така данни от
+ *  файл или сокет се четат директно във вектора, без предварително запълване.
  *
- *  @param  new_size    -   естествено число, нов брой на елементите на вектора
- *  @param  val         -   стойност, с която да се инициализират новодобавените елементи
+ *  @param  count       -   брой на новите елементи
+ *  @return указател към първия нов елемент
  */
-template<typename T, typename A>
-void Vector<T,A>::push_back(const T& val)
+template<typename T, typename A, typename G>
+T* Vector<T, A, G>::append_uninitialized(size_t count)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "append_uninitialized requires a trivially copyable T");
+
+    if (size() + count > static_cast<size_t>(capacity()))
+    {
+        reserve(next_capacity(size() + count));
+    }
+    T* first = base.space;
+    base.space += count;
+    VECTOR_STATS_HOOK(m_stats.constructions += count; m_stats.on_size(size()));
+    return first;
+}
+
+/**
+ *  Връща капацитета, до който трябва да нарасне векторът, за да побере required
+ *  елемента. Растежът се определя от политиката G.
+ *
+ *  @param  required    -   минимален брой елементи, които трябва да се поберат
+ */
+template<typename T, typename A, typename G>
+size_t Vector<T, A, G>::next_capacity(size_t required) const
+{
+    return G::grow(capacity(), required, sizeof(T));
+}
+
+/**
+ *  push_back се грижи за добавяне на нов елемент към вектора в задния край,
+ *  като копира val. Свежда се до emplace_back, който е безопасен и когато
+ *  val е елемент на самия вектор.
+ *
+ *  @param  val         -   стойност, която да се добави в края на вектора
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::push_back(const T& val)
+{
+    emplace_back(val);
+}
+
+/**
+ *  Вариант на push_back, който премества временен обект, вместо да го копира.
+ *
+ *  @param  val         -   стойност, която да се премести в края на вектора
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::push_back(T&& val)
+{
+    emplace_back(std::move(val));
+}
+
+/**
+ *  emplace_back конструира нов елемент директно в края на вектора, като
+ *  препраща аргументите към конструктора на T. В случай, че капацитетът е
+ *  изчерпан, нарастването се поема от realloc_emplace_back.
+ *
+ *  @param  args        -   аргументи за конструктора на новия елемент
+ *  @return референция към новия елемент
+ */
+template<typename T, typename A, typename G>
+template<typename... Args>
+T& Vector<T, A, G>::emplace_back(Args&&... args)
 {
     if (capacity() == size())                   // ако няма повече капацитет
     {
-        reserve( size() ? (round(GROWTH_RATE * size())) : INITIAL_SIZE );
+        realloc_emplace_back(std::forward<Args>(args)...);
+    }
+    else
+    {
+        alloc_traits::construct(base.alloc, base.space, std::forward<Args>(args)...);
+        VECTOR_STATS_HOOK(++m_stats.constructions);
+        ++base.space;                           // увеличи брояча на елементи
+    }
+    return back();
+}
+
+/**
+ *  Нарастване на вектора при добавяне в края. Аргументите може да сочат към
+ *  елемент на вектора, затова новият елемент се конструира преди старите
+ *  елементи да бъдат преместени: директно в новия буфер, или във временен
+ *  обект, ако паметта расте на място чрез realloc.
+ */
+template<typename T, typename A, typename G>
+template<typename... Args>
+void Vector<T, A, G>::realloc_emplace_back(Args&&... args)
+{
+    VECTOR_STATS_HOOK(size_t old_capacity = capacity());
+
+    if constexpr (decltype(base)::reallocatable)
+    {
+        T value(std::forward<Args>(args)...);
+        base.reallocate(next_capacity(size() + 1));
+        alloc_traits::construct(base.alloc, base.space, std::move(value));
+        ++base.space;
+    }
+    else
+    {
+        VectorBase<T, A> temp(base.alloc, size(), next_capacity(size() + 1) - size());
+        alloc_traits::construct(base.alloc, temp.space, std::forward<Args>(args)...);
+        uninitialized_move(base.first, base.space, temp.first);
+        ++temp.space;
+        base.space = base.first;                // старите елементи вече са унищожени
+        std::swap(base, temp);
+    }
+
+    VECTOR_STATS_HOOK(++m_stats.constructions; note_relocation(old_capacity, size() - 1));
+}
+
+/**
+ *  emplace конструира нов елемент на позиция index, като препраща аргументите
+ *  към конструктора на T. Елементите вдясно от index се изместват с една позиция
+ *  чрез преместване. Новият елемент първо се конструира във временен обект,
+ *  защото аргументите може да сочат към елемент, който ще бъде изместен.
+ *
+ *  @param  index   -   позиция на вмъкване във вектора
+ *  @param  args    -   аргументи за конструктора на новия елемент
+ *  @return референция към новия елемент
+ */
+template<typename T, typename A, typename G>
+template<typename... Args>
+T& Vector<T, A, G>::emplace(int index, Args&&... args)
+{
+    if (index == size())
+    {
+        return emplace_back(std::forward<Args>(args)...);
+    }
+
+    if constexpr (!decltype(base)::reallocatable)
+    {
+        if (size() == capacity())
+        {
+            realloc_emplace(index, std::forward<Args>(args)...);
+            return base.first[index];
+        }
     }
-    base.alloc.construct(base.space, val);
-    ++base.space;                               // увеличи брояча на елементи
+
+    T value(std::forward<Args>(args)...);
+    if (size() == capacity())
+    {
+        reserve(next_capacity(size() + 1));
+    }
+
+    alloc_traits::construct(base.alloc, base.space, std::move(*(base.space - 1)));
+    VECTOR_STATS_HOOK(++m_stats.constructions);
+    std::move_backward(base.first + index, base.space - 1, base.space);
+    ++base.space;
+    base.first[index] = std::move(value);
+    return base.first[index];
+}
+
+/**
+ *  Нарастване на вектора при вмъкване в средата. Новият елемент се конструира
+ *  директно на мястото си в новия буфер, след което елементите от двете страни
+ *  на index се преместват около него. Така всеки елемент се мести само веднъж.
+ */
+template<typename T, typename A, typename G>
+template<typename... Args>
+void Vector<T, A, G>::realloc_emplace(int index, Args&&... args)
+{
+    VECTOR_STATS_HOOK(size_t old_capacity = capacity());
+
+    VectorBase<T, A> temp(base.alloc, size() + 1, next_capacity(size() + 1) - size() - 1);
+    alloc_traits::construct(base.alloc, temp.first + index, std::forward<Args>(args)...);
+    uninitialized_move(base.first, base.first + index, temp.first);
+    uninitialized_move(base.first + index, base.space, temp.first + index + 1);
+    base.space = base.first;                    // старите елементи вече са унищожени
+    std::swap(base, temp);
+
+    VECTOR_STATS_HOOK(++m_stats.constructions; note_relocation(old_capacity, size() - 1));
 }
 
 /**
  *  pop_back() унищожава последният елемент във вектора, ако има такъв.
  */
-template<typename T, typename A>
-void Vector<T,A>::pop_back()
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::pop_back()
 {
     if(!empty())
     {
-        base.alloc.destroy(base.space - 1);
+        VECTOR_STATS_HOOK(m_stats.on_size(size()); ++m_stats.destructions);
+        alloc_traits::destroy(base.alloc, base.space - 1);
         --base.space;
     }
 }
 
 /**
- *  В случай, че искаме да добавим последен елемент, свеждаме решението до
- *  push_back. В противен случай се осигурява нужния капацитет.
- *  Конструира се елемента, който искаме да вмъкнем на позиция space
- *  (вече нов последен елемент), а swap_range_backwards чрез последователни
- *  съседни смени го измества на позиция index.
+ *  Вмъква копие на value на позиция index. Свежда се до emplace, който
+ *  измества елементите вдясно с една позиция и е безопасен и когато
+ *  value е елемент на самия вектор.
  *
  *  @param  index   -   позиция на вмъкване във вектора
  *  @param  value   -   стойност, която да се вмъкне във вектора
  */
-template<typename T, typename A>
-void Vector<T,A>::insert(int index, const T& value)
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::insert(int index, const T& value)
 {
-    if (index == size() + 1)
+    emplace(index, value);
+}
+
+/**
+ *  Вариант на insert, който премества временен обект, вместо да го копира.
+ *
+ *  @param  index   -   позиция на вмъкване във вектора
+ *  @param  value   -   стойност, която да се премести във вектора
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::insert(int index, T&& value)
+{
+    emplace(index, std::move(value));
+}
+
+/**
+ *  Вмъква count копия на value, започвайки от позиция index.
+ *  value се копира предварително, защото може да е елемент на вектора,
+ *  който ще бъде изместен.
+ *
+ *  @param  index   -   позиция на вмъкване във вектора
+ *  @param  count   -   брой на копията
+ *  @param  value   -   стойност, която да се вмъкне във вектора
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::insert(int index, size_t count, const T& value)
+{
+    if (count == 0)
     {
-        return push_back(value);
+        return;
     }
 
-    if (size() == capacity())
+    const T copy(value);
+    insert_range(index, repeat_iterator{&copy, 0},
+                 repeat_iterator{&copy, static_cast<std::ptrdiff_t>(count)}, count);
+}
+
+/**
+ *  Вмъква елементите на списъка values, започвайки от позиция index.
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::insert(int index, std::initializer_list<T> values)
+{
+    insert_range(index, values.begin(), values.end(), values.size());
+}
+
+/**
+ *  Вмъква копия на елементите от интервала [first, last), започвайки от позиция index.
+ *  Ако итераторите позволяват многократно обхождане, броят на елементите се
+ *  изчислява предварително и мястото се освобождава наведнъж. В противен случай
+ *  елементите първо се събират във временен вектор. Интервалът не бива да сочи
+ *  към елементи на самия вектор.
+ *
+ *  @param  index   -   позиция на вмъкване във вектора
+ *  @param  first   -   итератор към първия елемент, който да се вмъкне (включително)
+ *  @param  last    -   итератор към последния елемент, който да се вмъкне (изключващо)
+ */
+template<typename T, typename A, typename G>
+template<typename InputIt, typename>
+void Vector<T, A, G>::insert(int index, InputIt first, InputIt last)
+{
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
     {
-        reserve( size() ? (round(GROWTH_RATE * size())) : INITIAL_SIZE );
+        insert_range(index, first, last, std::distance(first, last));
     }
+    else
+    {
+        Vector<T, A, G> temp(base.alloc);
+        for (; first != last; ++first)
+        {
+            temp.emplace_back(*first);
+        }
+        insert_range(index, std::make_move_iterator(temp.base.first),
+                     std::make_move_iterator(temp.base.space), temp.size());
+    }
+}
 
-    base.alloc.construct(base.space, value);
-    swap_range_backwards(base.first + index, base.space);
-    ++base.space;
+/**
+ *  Вмъква n елемента от интервала [first, last) на позиция index с една-единствена
+ *  промяна на капацитета и едно изместване на опашката:
+ *  - ако капацитетът не стига и паметта не може да расте на място, новите
+ *    елементи се конструират директно в новия буфер, а старите се преместват
+ *    около тях, всеки само веднъж;
+ *  - иначе опашката [index, size()) се измества с n позиции надясно наведнъж,
+ *    чрез memmove за тривиално преместваемите типове или чрез едно преместване
+ *    отзад напред за останалите, и празнината се запълва.
+ */
+template<typename T, typename A, typename G>
+template<typename ForwardIt>
+void Vector<T, A, G>::insert_range(int index, ForwardIt first, ForwardIt last, size_t n)
+{
+    if (n == 0)
+    {
+        return;
+    }
+
+    if (size() + n > static_cast<size_t>(capacity()))
+    {
+        size_t new_capacity = next_capacity(size() + n);
+
+        if constexpr (decltype(base)::reallocatable)
+        {
+            reserve(new_capacity);
+        }
+        else
+        {
+            VECTOR_STATS_HOOK(size_t old_capacity = capacity());
+
+            VectorBase<T, A> temp(base.alloc, size() + n, new_capacity - size() - n);
+            uninitialized_copy_a(first, last, temp.first + index);
+            uninitialized_move(base.first, base.first + index, temp.first);
+            uninitialized_move(base.first + index, base.space, temp.first + index + n);
+            base.space = base.first;            // старите елементи вече са унищожени
+            std::swap(base, temp);
+
+            VECTOR_STATS_HOOK(note_relocation(old_capacity, size() - n));
+            return;
+        }
+    }
+
+    T* pos = base.first + index;
+    size_t tail = base.space - pos;
+
+    if constexpr (is_trivially_relocatable<T>::value)
+    {
+        std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos), tail * sizeof(T));
+        try
+        {
+            uninitialized_copy_a(first, last, pos);
+        }
+        catch (...)
+        {
+            std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + n), tail * sizeof(T));
+            throw;
+        }
+        base.space += n;
+    }
+    else if (tail > n)
+    {
+        // последните n елемента отиват в неинициализирана памет, останалите се изместват отзад напред;
+        // space се придвижва веднага след конструирането, за да се унищожат, ако следващите стъпки хвърлят
+        T* old_end = base.space;
+        uninitialized_copy_a(std::make_move_iterator(old_end - n), std::make_move_iterator(old_end), old_end);
+        base.space += n;
+        std::move_backward(pos, old_end - n, old_end);
+        std::copy(first, last, pos);
+    }
+    else
+    {
+        // опашката е по-къса от вмъкнатото: част от новите елементи попадат след стария край
+        T* old_end = base.space;
+        ForwardIt middle = first;
+        std::advance(middle, tail);
+        uninitialized_copy_a(middle, last, old_end);
+        base.space += n - tail;
+        uninitialized_copy_a(std::make_move_iterator(pos), std::make_move_iterator(old_end), pos + n);
+        base.space += tail;
+        std::copy(first, middle, pos);
+    }
 }
 
 /**
  *  erase трие елементът на позиция index, ако има елементи въобще.
- *  елементът се унищожава от алокатора, а std::move се грижи да
- *  запази инварианта на последователност на елементите на вектора,
- *  като измести всички елементи вдясно от изтрития една позиция наляво.
+ *  Свежда се до изтриване на интервала [index, index + 1).
  *
  *  @param  index   -   позицията на елемента, който ще бъде изтрит
  */
-template<typename T, typename A>
-void Vector<T,A>::erase(int index)
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::erase(int index)
 {
     if (empty())
     {
         return;
     }
 
-    base.alloc.destroy(base.first + index);
-    std::move(base.first + index + 1, base.space, base.first + index);  // премести наляво
+    erase(index, index + 1);
+}
+
+/**
+ *  Трие елементите в интервала [first, last) с едно-единствено изместване на опашката.
+ *  Елементите вдясно от last се преместват наляво върху изтритите, след което
+ *  се унищожават само останалите в края преместени обекти. За тривиално
+ *  преместваеми типове изтритите се унищожават, а опашката се мести с memmove.
+ *
+ *  @param  first   -   позиция на първия елемент, който да се изтрие (включително)
+ *  @param  last    -   позиция на последния елемент, който да се изтрие (изключващо)
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::erase(int first, int last)
+{
+    if (first == last)
+    {
+        return;
+    }
+
+    T* dest = base.first + first;
+    T* src = base.first + last;
+
+    if constexpr (is_trivially_relocatable<T>::value)
+    {
+        destroy_range(dest, src);
+        std::memmove(static_cast<void*>(dest), static_cast<const void*>(src), (base.space - src) * sizeof(T));
+        base.space -= last - first;
+    }
+    else
+    {
+        T* new_end = std::move(src, base.space, dest);     // премести наляво
+        destroy_range(new_end, base.space);
+        base.space = new_end;
+    }
+}
+
+/**
+ *  Трие елемента на позиция index за константно време, без да запазва наредбата:
+ *  на мястото му се премества последният елемент на вектора.
+ *
+ *  @param  index   -   позицията на елемента, който ще бъде изтрит
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::swap_erase(int index)
+{
+    T* back = base.space - 1;
+    if (base.first + index != back)
+    {
+        base.first[index] = std::move(*back);
+    }
+    VECTOR_STATS_HOOK(m_stats.on_size(size()); ++m_stats.destructions);
+    alloc_traits::destroy(base.alloc, back);
     --base.space;
 }
 
+/**
+ *  Трие всички елементи, равни на value, с едно обхождане на вектора.
+ *  value не бива да е елемент на самия вектор.
+ *
+ *  @param  value   -   стойност, с която се сравняват елементите
+ *  @return броят на изтритите елементи
+ */
+template<typename T, typename A, typename G>
+template<typename U>
+size_t Vector<T, A, G>::remove(const U& value)
+{
+    return remove_if([&value](const T& element) { return element == value; });
+}
+
+/**
+ *  Трие всички елементи, за които pred връща истина, с едно обхождане на вектора.
+ *  Запазените елементи се преместват наляво към началото (std::remove_if), а
+ *  накрая се унищожават само останалите в края преместени обекти.
+ *
+ *  @param  pred    -   предикат, който определя кои елементи да бъдат изтрити
+ *  @return броят на изтритите елементи
+ */
+template<typename T, typename A, typename G>
+template<typename Pred>
+size_t Vector<T, A, G>::remove_if(Pred pred)
+{
+    T* new_end = std::remove_if(base.first, base.space, pred);
+    size_t removed = base.space - new_end;
+    destroy_range(new_end, base.space);
+    base.space = new_end;
+    return removed;
+}
+
 /**
  *  Процедура за смаляване на капацитета до броя на елементите във вектора.
- *  Проста реализация чрез copy-and-swap идиома.
+ *  Колко точно да се смали (и дали изобщо) решава политиката на растеж G,
+ *  а елементите се преместват, а не копират, в новия буфер.
+ */
+template<typename T, typename A, typename G>
+void Vector<T, A, G>::shrink_to_fit()
+{
+    size_t new_capacity = G::shrink(size(), capacity(), sizeof(T));
+    if (new_capacity < static_cast<size_t>(capacity()))
+    {
+        relocate(new_capacity);
+    }
+}
+
+/**
+ *  Размяна на два вектора чрез размяна на буферите им. Алокаторите се разменят
+ *  само ако се разпространяват при размяна (propagate_on_container_swap), така че
+ *  всеки буфер остава при алокатора, който го е заделил. Иначе, както при
+ *  стандартните контейнери, алокаторите трябва да са равни.
  */
-template<typename T, typename A>
-void Vector<T, A>::shrink_to_fit()
+template<typename T, typename A, typename G>
+void swap(Vector<T, A, G>& a, Vector<T, A, G>& b)
 {
-    Vector<T, A> temp(*this);
-    swap(*this, temp);
+    if constexpr (std::allocator_traits<A>::propagate_on_container_swap::value)
+    {
+        std::swap(a.base.alloc, b.base.alloc);
+    }
+    else
+    {
+        assert(a.base.alloc == b.base.alloc && "Vector: swap of vectors with unequal allocators");
+    }
+    std::swap(a.base.first, b.base.first);
+    std::swap(a.base.space, b.base.space);
+    std::swap(a.base.last, b.base.last);
 }
 
 /**
- *  Тривиална имплементация на swap за два вектора.
+ *  Трие всички елементи на vec, равни на value. Аналог на std::erase.
  */
-template<typename T, typename A>
-void swap(Vector<T, A>& a, Vector<T, A>& b)
+template<typename T, typename A, typename G, typename U>
+size_t erase(Vector<T, A, G>& vec, const U& value)
 {
-    std::swap(a, b);
+    return vec.remove(value);
 }
 
+/**
+ *  Трие всички елементи на vec, за които pred е истина. Аналог на std::erase_if.
+ */
+template<typename T, typename A, typename G, typename Pred>
+size_t erase_if(Vector<T, A, G>& vec, Pred pred)
+{
+    return vec.remove_if(pred);
+}
+
+/**
+ *  Вектор, който взима паметта си от std::pmr::memory_resource.
+ */
+template<typename T>
+using PmrVector = Vector<T, std::pmr::polymorphic_allocator<T> >;
+
 #endif // VECTOR_H
@@ -1,15 +1,26 @@
 #ifndef VECTORBASE_H
 #define VECTORBASE_H
 
+#include "VectorTraits.h"
+#include "VectorStats.h"
 #include <iostream>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
 
 /**
- *  Помощен вектор, чрез който имплементираме RAII техниката
+ *  Помощен вектор, чрез който имплементираме RAII техниката.
+ *  Паметта се заделя и освобождава през std::allocator_traits, така че се
+ *  поддържат и алокатори със състояние (арени, std::pmr::polymorphic_allocator).
  */
 template<typename T, typename A = std::allocator<T> >
 class VectorBase
 {
 public:
+    using alloc_traits = std::allocator_traits<A>;
+    using size_type = typename alloc_traits::size_type;
+
     A alloc;        // управлението на паметта се делегира на алокатор
 	T* first;       // начало на заделеното пространство, маркира първият елемент
 	T* space;       // маркира едно място след последния елемент, съответно начало на свободния капацитет
@@ -21,8 +32,8 @@ public:
      *  @param  n - брой на елементите във вектора
      *  @param  m - брой на свободните позиции в оставащия капацитет на базовия вектор
      */
-    VectorBase(const A& a, typename A::size_type n, typename A::size_type m = 0)
-        : alloc(a), first(alloc.allocate(n + m)), space(first + n), last(first + n + m) {}
+    VectorBase(const A& a, size_type n, size_type m = 0)
+        : alloc(a), first(allocate(n + m)), space(first + n), last(first + n + m) {}
 
     VectorBase(const VectorBase& other) = delete;               // не искаме копиращ конструктор
     VectorBase& operator=(const VectorBase& other) = delete;    // не искаме копиращо присвояване
@@ -31,15 +42,118 @@ public:
     VectorBase& operator=(VectorBase&& other);
 
     ~VectorBase();
+
+    static constexpr bool reallocatable = is_reallocatable<T, A>::value;   // дали паметта може да расте чрез realloc
+
+    void reallocate(size_type new_capacity);
+
+private:
+    T* allocate(size_type n);
+    void deallocate(T* p, size_type n);
 };
 
+/**
+ *  Заделя памет за n елемента. Ако паметта може да расте на място (reallocatable),
+ *  тя се взима директно от malloc, за да може по-късно да се подаде на realloc.
+ *  В противен случай заделянето се делегира на алокатора. Празен буфер не заема памет.
+ */
+template<typename T, typename A>
+T* VectorBase<T, A>::allocate(size_type n)
+{
+    if (n == 0)
+    {
+        return nullptr;
+    }
+
+    T* p;
+    if constexpr (reallocatable)
+    {
+        p = static_cast<T*>(std::malloc(n * sizeof(T)));
+        if (!p)
+        {
+            throw std::bad_alloc();
+        }
+    }
+    else
+    {
+        p = alloc_traits::allocate(alloc, n);
+    }
+
+    VECTOR_STATS_HOOK(vector_type_stats<T>().on_allocate(n * sizeof(T)));      // само успешните заделяния
+    return p;
+}
+
+/**
+ *  Освобождава паметта по начина, по който е била заделена от allocate.
+ */
+template<typename T, typename A>
+void VectorBase<T, A>::deallocate(T* p, size_type n)
+{
+    VECTOR_STATS_HOOK(if (p) vector_type_stats<T>().on_deallocate());
+
+    if constexpr (reallocatable)
+    {
+        std::free(p);
+    }
+    else if (p)
+    {
+        alloc_traits::deallocate(alloc, p, n);
+    }
+}
+
+/**
+ *  Променя капацитета на място чрез std::realloc. Елементите се преместват
+ *  побитово (ако изобщо се наложи), затова функцията е достъпна само при
+ *  reallocatable == true. Броят на елементите се запазва.
+ *
+ *  @param  new_capacity    -   нов капацитет, не по-малък от броя на елементите
+ */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+// Когато два поредни reallocate на вектори от един тип се вградят в една функция
+// (напр. reserve на два успоредни вектора), GCC не може да докаже, че буферите им
+// са различни, и погрешно предупреждава, че вторият чете указател след първия realloc.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuse-after-free"
+#endif
+template<typename T, typename A>
+void VectorBase<T, A>::reallocate(size_type new_capacity)
+{
+    static_assert(reallocatable, "reallocate requires trivially relocatable T and std::allocator");
+
+    if (new_capacity == 0)
+    {
+        VECTOR_STATS_HOOK(if (first) vector_type_stats<T>().on_deallocate());
+        std::free(first);           // realloc с размер 0 не е еднозначно дефиниран
+        first = space = last = nullptr;
+        return;
+    }
+
+    size_type n = space - first;
+
+    void* p = std::realloc(static_cast<void*>(first), new_capacity * sizeof(T));
+    if (!p)
+    {
+        throw std::bad_alloc();     // старият буфер остава валиден
+    }
+
+    // отчита се едва след успешния realloc, за да не се брои освобождаване при bad_alloc
+    VECTOR_STATS_HOOK(if (first) vector_type_stats<T>().on_deallocate());
+    VECTOR_STATS_HOOK(vector_type_stats<T>().on_allocate(new_capacity * sizeof(T)));
+    first = static_cast<T*>(p);
+    space = first + n;
+    last = first + new_capacity;
+}
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic pop
+#endif
+
 /**
  *  алокатора се грижи да освободи първоначално заделената памет в деструктора
  */
 template<typename T, typename A>
 VectorBase<T, A>::~VectorBase()
 {
-    alloc.deallocate(first, last - first);
+    deallocate(first, last - first);
 }
 
 /**
@@ -49,18 +163,24 @@ VectorBase<T, A>::~VectorBase()
  */
 template<typename T, typename A>
 VectorBase<T, A>::VectorBase(VectorBase&& other)
-    : alloc(other.alloc), first(other.first), space(other.space), last(other.space)
+    : alloc(other.alloc), first(other.first), space(other.space), last(other.last)
 {
     other.first = other.space = other.last = nullptr;
 }
 
 /**
- *  оператор за преместващо присвояване, която разменя данните почленно
+ *  оператор за преместващо присвояване, която разменя данните почленно, заедно с алокаторите,
+ *  така че всеки буфер остава при алокатора, който го е заделил. Алокатори, които не могат
+ *  да се присвояват (напр. std::pmr::polymorphic_allocator), не се разпространяват и Vector
+ *  разменя буферите само когато двата алокатора са равни, затова тях не ги разменяме.
  */
 template<typename T, typename A>
 VectorBase<T, A>& VectorBase<T, A>::operator=(VectorBase&& other)
 {
-    std::swap(alloc, other.alloc);
+    if constexpr (std::is_move_assignable<A>::value)
+    {
+        std::swap(alloc, other.alloc);
+    }
     std::swap(first, other.first);
     std::swap(space, other.space);
     std::swap(last, other.last);
@@ -0,0 +1,111 @@
+#ifndef VECTORNUMERIC_H
+#define VECTORNUMERIC_H
+
+#include "Vector.h"
+#include "VectorSimd.h"
+
+/**
+ *  Числени операции над Vector от аритметичен тип, изпълнявани с векторизираните
+ *  ядра от VectorSimd.h. Заменят ръчните цикли по индекси от вида
+ *
+ *      for (int i = 0; i < v.size(); ++i) total += v[i];
+ *
+ *  Операциите, които приемат два вектора, изискват b да има поне толкова елементи, колкото a.
+ */
+
+/**
+ *  Присвоява value на всички елементи на вектора.
+ */
+template<typename T, typename A, typename G>
+void fill(Vector<T, A, G>& vec, const T& value)
+{
+    simd_fill(vec.data(), static_cast<size_t>(vec.size()), value);
+}
+
+/**
+ *  Сума на елементите; 0 за празен вектор.
+ */
+template<typename T, typename A, typename G>
+T sum(const Vector<T, A, G>& vec)
+{
+    return simd_sum(vec.data(), static_cast<size_t>(vec.size()));
+}
+
+/**
+ *  Скаларно произведение на a и първите a.size() елемента на b.
+ */
+template<typename T, typename A, typename G>
+T dot(const Vector<T, A, G>& a, const Vector<T, A, G>& b)
+{
+    return simd_dot(a.data(), b.data(), static_cast<size_t>(a.size()));
+}
+
+/**
+ *  Минимален и максимален елемент на непразен вектор.
+ */
+template<typename T, typename A, typename G>
+T min_value(const Vector<T, A, G>& vec)
+{
+    return simd_min(vec.data(), static_cast<size_t>(vec.size()));
+}
+
+template<typename T, typename A, typename G>
+T max_value(const Vector<T, A, G>& vec)
+{
+    return simd_max(vec.data(), static_cast<size_t>(vec.size()));
+}
+
+/**
+ *  Поелементни out = a + b, out = a - b и out = a * b. Размерът на out става a.size();
+ *  out може да е същият вектор като a или b.
+ */
+template<typename T, typename A, typename G>
+void add(const Vector<T, A, G>& a, const Vector<T, A, G>& b, Vector<T, A, G>& out)
+{
+    out.resize(a.size());
+    simd_transform<SimdOp::add>(a.data(), b.data(), out.data(), static_cast<size_t>(a.size()));
+}
+
+template<typename T, typename A, typename G>
+void subtract(const Vector<T, A, G>& a, const Vector<T, A, G>& b, Vector<T, A, G>& out)
+{
+    out.resize(a.size());
+    simd_transform<SimdOp::subtract>(a.data(), b.data(), out.data(), static_cast<size_t>(a.size()));
+}
+
+template<typename T, typename A, typename G>
+void multiply(const Vector<T, A, G>& a, const Vector<T, A, G>& b, Vector<T, A, G>& out)
+{
+    out.resize(a.size());
+    simd_transform<SimdOp::multiply>(a.data(), b.data(), out.data(), static_cast<size_t>(a.size()));
+}
+
+/**
+ *  Индекс на първия елемент, равен на value, или -1, ако няма такъв.
+ */
+template<typename T, typename A, typename G>
+int find(const Vector<T, A, G>& vec, const T& value)
+{
+    size_t index = simd_find(vec.data(), static_cast<size_t>(vec.size()), value);
+    return index == static_cast<size_t>(vec.size()) ? -1 : static_cast<int>(index);
+}
+
+/**
+ *  Брой елементи, равни на value.
+ */
+template<typename T, typename A, typename G>
+size_t count(const Vector<T, A, G>& vec, const T& value)
+{
+    return simd_count(vec.data(), static_cast<size_t>(vec.size()), value);
+}
+
+/**
+ *  Заменя всеки елемент със сумата на него и всички преди него.
+ */
+template<typename T, typename A, typename G>
+void prefix_sum(Vector<T, A, G>& vec)
+{
+    simd_prefix_sum(vec.data(), static_cast<size_t>(vec.size()));
+}
+
+#endif // VECTORNUMERIC_H
@@ -0,0 +1,220 @@
+#ifndef VECTORPARALLEL_H
+#define VECTORPARALLEL_H
+
+#include "Vector.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ *  Паралелни алгоритми над Vector. Непрекъснатият масив [base.first, base.space)
+ *  се разделя от parallel_chunks на парчета с граници на кеш линия, които се
+ *  изпълняват в пула на policy (по подразбиране default_thread_pool()).
+ *  Малките вектори се обработват изцяло в извикващата нишка.
+ */
+
+/**
+ *  Дали паралелното копиране и запълване могат да пишат байтовете директно, без
+ *  конструктори: тривиално копируеми T и алокатор без собствени construct/destroy.
+ */
+template<typename T, typename A>
+constexpr bool parallel_initializable = std::is_trivially_copyable<T>::value && is_plain_allocator<A>::value;
+
+/**
+ *  Паралелно копие на голям вектор. При parallel_initializable буферът се копира на
+ *  парчета в пула на policy; всяка нишка първа пише в своето парче, така че страниците
+ *  му се заделят в нейния NUMA възел. За останалите типове е обикновено копие.
+ *
+ *      Vector<double> copy = parallel_copy(big);
+ *
+ *  @param  vec     -   вектор, който да се копира
+ *  @param  policy  -   parallel или ParallelExecution{&pool}
+ *  @return копие с капацитет vec.size()
+ */
+template<typename T, typename A, typename G>
+Vector<T, A, G> parallel_copy(const Vector<T, A, G>& vec, ParallelExecution policy = parallel)
+{
+    if constexpr (parallel_initializable<T, A>)
+    {
+        Vector<T, A, G> copy(std::allocator_traits<A>::select_on_container_copy_construction(vec.get_allocator()));
+        size_t n = static_cast<size_t>(vec.size());
+        copy.reserve(n);
+        const T* source = vec.data();
+        T* dest = copy.append_uninitialized(n);
+        parallel_chunks(policy.get_pool(), dest, n, [source, dest](T* begin, T* end, size_t)
+        {
+            if (begin != end)
+            {
+                std::memcpy(static_cast<void*>(begin), source + (begin - dest), (end - begin) * sizeof(T));
+            }
+        });
+        return copy;
+    }
+    else
+    {
+        return vec;
+    }
+}
+
+/**
+ *  Паралелен вариант на vec.resize(new_size, val). При parallel_initializable новите
+ *  елементи се запълват на парчета в пула на policy, така че при първото им докосване
+ *  страниците се заделят в NUMA възела на нишката, която ще ги запълни. Буферът не се
+ *  докосва предварително. Намаляването и останалите типове използват обикновения resize.
+ *
+ *      parallel_resize(big, n, 0.0);
+ *
+ *  @param  vec         -   вектор
+ *  @param  new_size    -   нов брой елементи
+ *  @param  val         -   стойност на новите елементи
+ *  @param  policy      -   parallel или ParallelExecution{&pool}
+ */
+template<typename T, typename A, typename G>
+void parallel_resize(Vector<T, A, G>& vec, size_t new_size, const T& val, ParallelExecution policy = parallel)
+{
+    if constexpr (parallel_initializable<T, A>)
+    {
+        if (static_cast<size_t>(vec.size()) < new_size)
+        {
+            vec.reserve(new_size);
+            size_t count = new_size - vec.size();
+            T* first = vec.append_uninitialized(count);
+            parallel_chunks(policy.get_pool(), first, count, [&val](T* begin, T* end, size_t)
+            {
+                std::uninitialized_fill(begin, end, val);
+            });
+            return;
+        }
+    }
+    vec.resize(new_size, val);
+}
+
+/**
+ *  Извиква f(element) за всеки елемент на вектора. Редът на извикванията не е определен.
+ *
+ *  @param  vec     -   вектор, чиито елементи f може да променя
+ *  @param  f       -   функция f(T&); извиква се едновременно от няколко нишки
+ *  @param  policy  -   parallel или ParallelExecution{&pool}
+ */
+template<typename T, typename A, typename G, typename F>
+void parallel_for(Vector<T, A, G>& vec, F f, ParallelExecution policy = parallel)
+{
+    parallel_chunks(policy.get_pool(), vec.data(), static_cast<size_t>(vec.size()), [&f](T* begin, T* end, size_t)
+    {
+        for (; begin != end; ++begin)
+        {
+            f(*begin);
+        }
+    });
+}
+
+/**
+ *  out[i] = f(in[i]) за всяко i. Размерът на out става in.size(); новите елементи
+ *  първо се конструират с U() (паралелно при тривиални U), след което се презаписват.
+ *
+ *  @param  in      -   входен вектор
+ *  @param  out     -   изходен вектор; може да е същият като in, ако U е T
+ *  @param  f       -   функция U f(const T&)
+ *  @param  policy  -   parallel или ParallelExecution{&pool}
+ */
+template<typename T, typename A, typename G, typename U, typename B, typename H, typename F>
+void parallel_transform(const Vector<T, A, G>& in, Vector<U, B, H>& out, F f, ParallelExecution policy = parallel)
+{
+    parallel_resize(out, static_cast<size_t>(in.size()), U(), policy);
+
+    const T* source = in.data();
+    U* dest = out.data();
+    parallel_chunks(policy.get_pool(), dest, static_cast<size_t>(in.size()), [source, dest, &f](U* begin, U* end, size_t)
+    {
+        for (const T* from = source + (begin - dest); begin != end; ++begin, ++from)
+        {
+            *begin = f(*from);
+        }
+    });
+}
+
+/**
+ *  Свива елементите с асоциативната операция op: op(...op(op(init, v[0]), v[1])..., v[n-1]),
+ *  като всяко парче се свива отделно, а резултатите се комбинират по реда на парчетата.
+ *  Операцията не е нужно да е комутативна.
+ *
+ *  @param  vec     -   вектор
+ *  @param  init    -   начална стойност; връща се за празен вектор
+ *  @param  op      -   асоциативна функция R op(R, const T&) и R op(R, R)
+ *  @param  policy  -   parallel или ParallelExecution{&pool}
+ */
+template<typename T, typename A, typename G, typename R, typename Op = std::plus<> >
+R parallel_reduce(const Vector<T, A, G>& vec, R init, Op op = Op(), ParallelExecution policy = parallel)
+{
+    ThreadPool& pool = policy.get_pool();
+    size_t n = static_cast<size_t>(vec.size());
+
+    // частичният резултат на всяко непразно парче започва от първия му елемент
+    std::vector<std::pair<bool, R> > partials(parallel_chunk_count(pool, n, sizeof(T)), std::make_pair(false, init));
+    parallel_chunks(pool, vec.data(), n, [&partials, &op](const T* begin, const T* end, size_t chunk)
+    {
+        if (begin == end)
+        {
+            return;
+        }
+        R partial = R(*begin);
+        for (++begin; begin != end; ++begin)
+        {
+            partial = op(std::move(partial), *begin);
+        }
+        partials[chunk] = std::make_pair(true, std::move(partial));
+    });
+
+    for (std::pair<bool, R>& partial : partials)
+    {
+        if (partial.first)
+        {
+            init = op(std::move(init), std::move(partial.second));
+        }
+    }
+    return init;
+}
+
+/**
+ *  Сортира вектора: парчетата се сортират паралелно със std::sort, след което
+ *  съседните сортирани интервали се сливат по двойки (също паралелно) със
+ *  std::inplace_merge, докато остане един. Не е стабилно сортиране.
+ *
+ *  @param  vec     -   вектор
+ *  @param  comp    -   строга слаба наредба
+ *  @param  policy  -   parallel или ParallelExecution{&pool}
+ */
+template<typename T, typename A, typename G, typename Compare = std::less<> >
+void parallel_sort(Vector<T, A, G>& vec, Compare comp = Compare(), ParallelExecution policy = parallel)
+{
+    ThreadPool& pool = policy.get_pool();
+    T* first = vec.data();
+    size_t n = static_cast<size_t>(vec.size());
+    size_t chunks = parallel_chunk_count(pool, n, sizeof(T));
+
+    std::vector<size_t> bounds(chunks + 1, n);     // начало на всяко парче и краят на масива
+    parallel_chunks(pool, first, n, [first, &bounds, &comp](T* begin, T* end, size_t chunk)
+    {
+        bounds[chunk] = begin - first;
+        std::sort(begin, end, comp);
+    });
+
+    for (size_t width = 1; width < chunks; width *= 2)
+    {
+        size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+        pool.run(pairs, [first, width, chunks, &bounds, &comp](size_t pair)
+        {
+            size_t left = 2 * width * pair;
+            size_t middle = std::min(left + width, chunks);
+            size_t right = std::min(left + 2 * width, chunks);
+            std::inplace_merge(first + bounds[left], first + bounds[middle], first + bounds[right], comp);
+        });
+    }
+}
+
+#endif // VECTORPARALLEL_H
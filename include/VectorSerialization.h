@@ -0,0 +1,637 @@
+#ifndef VECTORSERIALIZATION_H
+#define VECTORSERIALIZATION_H
+
+#include "Vector.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/**
+ *  Двоичен формат за запис и четене на Vector през файлов дескриптор (файл, pipe, сокет).
+ *  Всеки вектор в потока е заглавие (VectorStreamHeader), последвано от елементите:
+ *  - при тривиално копируеми T (encoding raw) - масивът байт по байт, записан и прочетен
+ *    директно от/в паметта на вектора с един writev/readv, без междинно копие;
+ *  - при останалите T (encoding elements) - елемент по елемент чрез VectorSerializer<T>.
+ *
+ *  Заглавието пази версията, реда на байтовете на писателя, кода на типа, sizeof(T) и броя
+ *  елементи. Числата се обръщат автоматично при четене на поток, записан с другия ред на
+ *  байтовете. Няколко вектора може да се запишат един след друг в един поток.
+ *
+ *      VectorWriter out(fd);
+ *      out.write(prices);
+ *      out.write(names);
+ *      out.flush();
+ *
+ *      VectorReader in(fd);
+ *      in.read(prices);                                // reserve веднъж, според заглавието
+ *      in.begin_vector<std::string>();                 // или на парчета, без целия вектор в паметта
+ *      while (in.read_chunk(chunk, 1 << 16)) { ... }
+ *
+ *  Системните грешки се съобщават със std::system_error, а невалидният или
+ *  несъвместим поток - със std::runtime_error.
+ */
+
+/**
+ *  Заглавие на вектор в потока (32 байта).
+ */
+struct VectorStreamHeader
+{
+    char magic[4];                  // "VSER"
+    std::uint32_t byte_order;       // 0x01020304 в реда на байтовете на писателя
+    std::uint16_t version;
+    std::uint8_t encoding;          // VectorStreamHeader::raw или VectorStreamHeader::elements
+    std::uint8_t type_code;         // serial_type_code<T>(), 0 за потребителски типове
+    std::uint32_t element_size;     // sizeof(T)
+    std::uint64_t size;             // брой елементи
+    std::uint64_t reserved;
+
+    static constexpr std::uint16_t current_version = 1;
+    static constexpr std::uint32_t native_order = 0x01020304;
+    static constexpr std::uint8_t raw = 0;
+    static constexpr std::uint8_t elements = 1;
+};
+
+static_assert(sizeof(VectorStreamHeader) == 32, "VectorStreamHeader must be 32 bytes");
+
+/**
+ *  Код на аритметичните типове в заглавието. Разграничава напр. int32 от float
+ *  със същия размер; за останалите типове е 0 и се проверява само sizeof(T).
+ */
+template<typename T>
+constexpr std::uint8_t serial_type_code()
+{
+    if constexpr (std::is_same<T, bool>::value)                 return 1;
+    else if constexpr (std::is_same<T, char>::value)            return 2;
+    else if constexpr (std::is_integral<T>::value)              return (std::is_signed<T>::value ? 3 : 4) + 2 * (sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : sizeof(T) == 8 ? 3 : 0);
+    else if constexpr (std::is_same<T, float>::value)           return 11;
+    else if constexpr (std::is_same<T, double>::value)          return 12;
+    else                                                        return 0;
+}
+
+/**
+ *  Връща value с обърнат ред на байтовете (за аритметични типове с размер 2, 4 или 8).
+ */
+template<typename T>
+T byte_swapped(T value)
+{
+    if constexpr (sizeof(T) == 2)
+    {
+        std::uint16_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = __builtin_bswap16(bits);
+        std::memcpy(&value, &bits, sizeof(bits));
+    }
+    else if constexpr (sizeof(T) == 4)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = __builtin_bswap32(bits);
+        std::memcpy(&value, &bits, sizeof(bits));
+    }
+    else if constexpr (sizeof(T) == 8)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = __builtin_bswap64(bits);
+        std::memcpy(&value, &bits, sizeof(bits));
+    }
+    return value;
+}
+
+class VectorWriter;
+class VectorReader;
+
+/**
+ *  Как се записва и чете един елемент. По подразбиране тривиално копируемите типове
+ *  се записват като байтове (bulk = true, целият вектор наведнъж). Потребителските
+ *  типове се включват със специализация, която записва полетата им поотделно:
+ *
+ *      template<> struct VectorSerializer<Student>
+ *      {
+ *          static constexpr bool bulk = false;
+ *          static void write(VectorWriter& out, const Student& s)  { VectorSerializer<std::string>::write(out, s.name); out.write_value(s.age); }
+ *          static Student read(VectorReader& in)                   { std::string name = VectorSerializer<std::string>::read(in); return Student(name, in.read_value<int>()); }
+ *      };
+ */
+template<typename T>
+struct VectorSerializer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "specialize VectorSerializer for types that are not trivially copyable");
+
+    static constexpr bool bulk = true;
+
+    static void write(VectorWriter& out, const T& value);
+    static T read(VectorReader& in);
+};
+
+/**
+ *  Буфериран писател върху файлов дескриптор. Малките записи се събират в буфер,
+ *  а големите блокове (масивите на тривиалните вектори) се подават на ядрото
+ *  директно, заедно с натрупаното в буфера, с един writev.
+ *  Дескрипторът не се затваря от писателя.
+ */
+class VectorWriter
+{
+public:
+    static constexpr size_t buffer_size = 64 * 1024;
+
+    explicit VectorWriter(int fd) : m_fd(fd), m_buffer(new char[buffer_size]) {}
+    VectorWriter(const VectorWriter& other) = delete;
+    VectorWriter& operator=(const VectorWriter& other) = delete;
+    ~VectorWriter();
+
+    void write_bytes(const void* data, size_t bytes);
+    template<typename U>
+    void write_value(const U& value)    { static_assert(std::is_trivially_copyable<U>::value, "write_value requires a trivially copyable type"); write_bytes(&value, sizeof(U)); }
+    template<typename T, typename A, typename G>
+    void write(const Vector<T, A, G>& vec);
+    void flush();
+
+private:
+    void write_all(iovec* parts, int count);
+
+    int m_fd;
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_used = 0;                  // байтове в буфера, които още не са записани
+};
+
+/**
+ *  Буфериран четец върху файлов дескриптор. Големите блокове се четат с readv
+ *  директно в паметта на вектора, като в същото извикване буферът се запълва
+ *  със следващите байтове от потока. Дескрипторът не се затваря от четеца.
+ */
+class VectorReader
+{
+public:
+    static constexpr size_t buffer_size = 64 * 1024;
+
+    explicit VectorReader(int fd) : m_fd(fd), m_buffer(new char[buffer_size]) {}
+    VectorReader(const VectorReader& other) = delete;
+    VectorReader& operator=(const VectorReader& other) = delete;
+
+    void read_bytes(void* data, size_t bytes);
+    template<typename U>
+    U read_value();
+
+    template<typename T>
+    size_t begin_vector();
+    template<typename T, typename A, typename G>
+    size_t read_chunk(Vector<T, A, G>& chunk, size_t max_count);
+    template<typename T, typename A, typename G>
+    void read(Vector<T, A, G>& vec);
+
+    size_t remaining() const            { return m_remaining; }     // непрочетени елементи от текущия вектор
+    bool byte_swapped_stream() const    { return m_swap; }          // дали потокът е с обратен ред на байтовете
+
+private:
+    template<typename T, typename A, typename G>
+    void read_elements(Vector<T, A, G>& vec, size_t count);
+
+    int m_fd;
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_begin = 0;                 // непрочетените байтове в буфера са [m_begin, m_end)
+    size_t m_end = 0;
+    size_t m_remaining = 0;
+    bool m_swap = false;
+};
+
+template<typename T>
+void VectorSerializer<T>::write(VectorWriter& out, const T& value)
+{
+    out.write_value(value);
+}
+
+template<typename T>
+T VectorSerializer<T>::read(VectorReader& in)
+{
+    return in.read_value<T>();
+}
+
+/**
+ *  Низовете се записват като дължина (uint64) и символи.
+ */
+template<typename C, typename Traits, typename Alloc>
+struct VectorSerializer<std::basic_string<C, Traits, Alloc> >
+{
+    static constexpr bool bulk = false;
+
+    static void write(VectorWriter& out, const std::basic_string<C, Traits, Alloc>& value)
+    {
+        out.write_value(static_cast<std::uint64_t>(value.size()));
+        out.write_bytes(value.data(), value.size() * sizeof(C));
+    }
+
+    static std::basic_string<C, Traits, Alloc> read(VectorReader& in)
+    {
+        std::basic_string<C, Traits, Alloc> value(in.read_value<std::uint64_t>(), C());
+        in.read_bytes(&value[0], value.size() * sizeof(C));
+        if (in.byte_swapped_stream() && sizeof(C) > 1)
+        {
+            for (C& c : value)
+            {
+                c = byte_swapped(c);
+            }
+        }
+        return value;
+    }
+};
+
+/**
+ *  Вложените вектори се записват като пълни вектори със собствено заглавие.
+ */
+template<typename T, typename A, typename G>
+struct VectorSerializer<Vector<T, A, G> >
+{
+    static constexpr bool bulk = false;
+
+    static void write(VectorWriter& out, const Vector<T, A, G>& value)  { out.write(value); }
+
+    static Vector<T, A, G> read(VectorReader& in)
+    {
+        Vector<T, A, G> value;
+        in.read(value);
+        return value;
+    }
+};
+
+/**
+ *  Записва останалите в буфера байтове; грешките в деструктора се пренебрегват,
+ *  затова за да ги видите, извикайте flush() явно.
+ */
+inline VectorWriter::~VectorWriter()
+{
+    try
+    {
+        flush();
+    }
+    catch (...)
+    {
+    }
+}
+
+/**
+ *  Записва parts изцяло, като повтаря writev при частичен запис или прекъсване.
+ */
+inline void VectorWriter::write_all(iovec* parts, int count)
+{
+    while (count)
+    {
+        ssize_t written = ::writev(m_fd, parts, count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "VectorWriter: writev");
+        }
+        size_t left = static_cast<size_t>(written);
+        for (; count && left >= parts->iov_len; --count, ++parts)
+        {
+            left -= parts->iov_len;
+        }
+        if (count)
+        {
+            parts->iov_base = static_cast<char*>(parts->iov_base) + left;
+            parts->iov_len -= left;
+        }
+    }
+}
+
+/**
+ *  Записва bytes байта от data. Блокове, които не се побират в буфера, се записват
+ *  заедно с него с един writev, без да се копират.
+ */
+inline void VectorWriter::write_bytes(const void* data, size_t bytes)
+{
+    if (bytes == 0)
+    {
+        return;                         // data може да е nullptr (празен вектор)
+    }
+    if (m_used + bytes <= buffer_size)
+    {
+        std::memcpy(m_buffer.get() + m_used, data, bytes);
+        m_used += bytes;
+        return;
+    }
+    if (bytes < buffer_size)
+    {
+        flush();
+        std::memcpy(m_buffer.get(), data, bytes);
+        m_used = bytes;
+        return;
+    }
+
+    iovec parts[2] = {{m_buffer.get(), m_used}, {const_cast<void*>(data), bytes}};
+    bool pending = m_used != 0;
+    m_used = 0;
+    write_all(pending ? parts : parts + 1, pending ? 2 : 1);
+}
+
+/**
+ *  Записва натрупаното в буфера.
+ */
+inline void VectorWriter::flush()
+{
+    if (m_used)
+    {
+        iovec part = {m_buffer.get(), m_used};
+        m_used = 0;
+        write_all(&part, 1);
+    }
+}
+
+/**
+ *  Записва заглавието и елементите на vec.
+ */
+template<typename T, typename A, typename G>
+void VectorWriter::write(const Vector<T, A, G>& vec)
+{
+    VectorStreamHeader header = {};
+    std::memcpy(header.magic, "VSER", sizeof(header.magic));
+    header.byte_order = VectorStreamHeader::native_order;
+    header.version = VectorStreamHeader::current_version;
+    header.encoding = VectorSerializer<T>::bulk ? VectorStreamHeader::raw : VectorStreamHeader::elements;
+    header.type_code = serial_type_code<T>();
+    header.element_size = sizeof(T);
+    header.size = static_cast<std::uint64_t>(vec.size());
+    write_value(header);
+
+    if constexpr (VectorSerializer<T>::bulk)
+    {
+        write_bytes(vec.data(), vec.size() * sizeof(T));
+    }
+    else
+    {
+        for (int i = 0; i < vec.size(); ++i)
+        {
+            VectorSerializer<T>::write(*this, vec[i]);
+        }
+    }
+}
+
+/**
+ *  Прочита точно bytes байта в data. Остатъкът в буфера се копира, а ако
+ *  липсват поне buffer_size байта, те се четат директно в data с readv,
+ *  който едновременно запълва и буфера с продължението на потока.
+ */
+inline void VectorReader::read_bytes(void* data, size_t bytes)
+{
+    if (bytes == 0)
+    {
+        return;
+    }
+
+    char* dest = static_cast<char*>(data);
+    size_t buffered = std::min(bytes, m_end - m_begin);
+    std::memcpy(dest, m_buffer.get() + m_begin, buffered);
+    m_begin += buffered;
+    dest += buffered;
+    bytes -= buffered;
+
+    while (bytes)
+    {
+        iovec parts[2] = {{dest, bytes}, {m_buffer.get(), buffer_size}};
+        bool direct = bytes >= buffer_size;
+        ssize_t got = direct ? ::readv(m_fd, parts, 2) : ::read(m_fd, m_buffer.get(), buffer_size);
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "VectorReader: read");
+        }
+        if (got == 0)
+        {
+            throw std::runtime_error("VectorReader: unexpected end of stream");
+        }
+
+        size_t count = static_cast<size_t>(got);
+        if (direct)
+        {
+            size_t into_dest = std::min(count, bytes);
+            dest += into_dest;
+            bytes -= into_dest;
+            m_begin = 0;
+            m_end = count - into_dest;
+        }
+        else
+        {
+            size_t into_dest = std::min(count, bytes);
+            std::memcpy(dest, m_buffer.get(), into_dest);
+            dest += into_dest;
+            bytes -= into_dest;
+            m_begin = into_dest;
+            m_end = count;
+        }
+    }
+}
+
+/**
+ *  Прочита стойност от тривиално копируем тип, като обръща байтовете ѝ, ако
+ *  потокът е записан с другия ред и типът е аритметичен.
+ */
+template<typename U>
+U VectorReader::read_value()
+{
+    static_assert(std::is_trivially_copyable<U>::value, "read_value requires a trivially copyable type");
+    U value;
+    read_bytes(&value, sizeof(U));
+    if constexpr (std::is_arithmetic<U>::value)
+    {
+        if (m_swap)
+        {
+            value = byte_swapped(value);
+        }
+    }
+    return value;
+}
+
+/**
+ *  Прочита и проверява заглавието на следващия вектор в потока. Елементите след
+ *  това се четат с read_chunk.
+ *
+ *  @return броят на елементите на вектора
+ */
+template<typename T>
+size_t VectorReader::begin_vector()
+{
+    VectorStreamHeader header;
+    read_bytes(&header, sizeof(header));
+
+    if (std::memcmp(header.magic, "VSER", sizeof(header.magic)) != 0)
+    {
+        throw std::runtime_error("VectorReader: not a vector stream");
+    }
+    if (header.byte_order == VectorStreamHeader::native_order)
+    {
+        m_swap = false;
+    }
+    else if (header.byte_order == byte_swapped(VectorStreamHeader::native_order))
+    {
+        m_swap = true;
+        header.version = byte_swapped(header.version);
+        header.element_size = byte_swapped(header.element_size);
+        header.size = byte_swapped(header.size);
+    }
+    else
+    {
+        throw std::runtime_error("VectorReader: corrupted byte order mark");
+    }
+
+    std::uint8_t encoding = VectorSerializer<T>::bulk ? VectorStreamHeader::raw : VectorStreamHeader::elements;
+    if (header.version > VectorStreamHeader::current_version)
+    {
+        throw std::runtime_error("VectorReader: unsupported stream version " + std::to_string(header.version));
+    }
+    if (header.type_code != serial_type_code<T>() || header.element_size != sizeof(T) || header.encoding != encoding)
+    {
+        throw std::runtime_error("VectorReader: the stream holds a different element type");
+    }
+    if (m_swap && encoding == VectorStreamHeader::raw && sizeof(T) > 1 && !std::is_arithmetic<T>::value)
+    {
+        throw std::runtime_error("VectorReader: cannot convert the byte order of a user-defined type");
+    }
+
+    m_remaining = static_cast<size_t>(header.size);
+    return m_remaining;
+}
+
+/**
+ *  Добавя count елемента от потока в края на vec. Ако потокът свърши или е повреден,
+ *  vec остава с размера, който е имал преди извикването.
+ */
+template<typename T, typename A, typename G>
+void VectorReader::read_elements(Vector<T, A, G>& vec, size_t count)
+{
+    size_t remaining = m_remaining;     // вложените вектори променят m_remaining
+    int old_size = vec.size();
+    if constexpr (VectorSerializer<T>::bulk)
+    {
+        // байтовете се четат в свободния капацитет, а размерът се увеличава едва след като
+        // са прочетени всички, за да не останат неинициализирани елементи при грешка
+        vec.reserve(static_cast<size_t>(old_size) + count);
+        T* first = vec.data() + old_size;
+        read_bytes(first, count * sizeof(T));
+        if constexpr (std::is_arithmetic<T>::value && sizeof(T) > 1)
+        {
+            if (m_swap)
+            {
+                std::transform(first, first + count, first, byte_swapped<T>);
+            }
+        }
+        vec.append_uninitialized(count);
+    }
+    else
+    {
+        try
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                vec.emplace_back(VectorSerializer<T>::read(*this));
+            }
+        }
+        catch (...)
+        {
+            vec.erase(old_size, vec.size());
+            throw;
+        }
+    }
+    m_remaining = remaining - count;
+}
+
+/**
+ *  Прочита следващите до max_count елемента на текущия вектор (виж begin_vector) в
+ *  chunk, като старото съдържание на chunk се изтрива. Така вектор, по-голям от
+ *  паметта, се обработва на парчета, а буферът на chunk се преизползва.
+ *
+ *  @param  chunk       -   вектор, в който да се прочетат елементите
+ *  @param  max_count   -   най-много елементи в парчето
+ *  @return броят на прочетените елементи; 0, когато векторът в потока е прочетен
+ */
+template<typename T, typename A, typename G>
+size_t VectorReader::read_chunk(Vector<T, A, G>& chunk, size_t max_count)
+{
+    size_t count = std::min(max_count, m_remaining);
+    chunk.clear();
+    chunk.reserve(count);
+    read_elements(chunk, count);
+    return count;
+}
+
+/**
+ *  Прочита следващия вектор от потока във vec, като замества съдържанието му.
+ *  Капацитетът се заделя веднъж, според броя в заглавието.
+ */
+template<typename T, typename A, typename G>
+void VectorReader::read(Vector<T, A, G>& vec)
+{
+    size_t count = begin_vector<T>();
+    vec.clear();
+    vec.reserve(count);
+    read_elements(vec, count);
+}
+
+/**
+ *  Записва vec във файла path (съществуващ файл се презаписва).
+ */
+template<typename T, typename A, typename G>
+void save_vector(const std::string& path, const Vector<T, A, G>& vec)
+{
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "save_vector: open " + path);
+    }
+    try
+    {
+        VectorWriter out(fd);
+        out.write(vec);
+        out.flush();
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "save_vector: close " + path);
+    }
+}
+
+/**
+ *  Прочита във vec първия вектор от файла path.
+ */
+template<typename T, typename A, typename G>
+void load_vector(const std::string& path, Vector<T, A, G>& vec)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "load_vector: open " + path);
+    }
+    try
+    {
+        VectorReader in(fd);
+        in.read(vec);
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+}
+
+#endif // VECTORSERIALIZATION_H
@@ -0,0 +1,363 @@
+#ifndef VECTORSIMD_H
+#define VECTORSIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/**
+ *  Векторизирани числени ядра върху непрекъснати масиви от аритметични типове
+ *  с избор на набора от инструкции по време на изпълнение.
+ *
+ *  На x86 с GCC ядрата от VectorSimdKernels.h се компилират по веднъж за SSE2,
+ *  AVX2 и AVX-512 (чрез #pragma GCC target), а при зареждане на програмата се проверява
+ *  какво поддържа процесорът. На други платформи и компилатори се използват само
+ *  скаларните ядра. Операциите над Vector са във VectorNumeric.h.
+ */
+
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_SIMD_X86 1
+#else
+#define VECTOR_SIMD_X86 0
+#endif
+
+/**
+ *  Нива на векторизация, подредени по нарастваща ширина на регистрите.
+ */
+enum class SimdLevel
+{
+    scalar,
+    sse2,
+    avx2,
+    avx512
+};
+
+inline const char* simd_level_name(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::sse2:   return "sse2";
+    case SimdLevel::avx2:   return "avx2";
+    case SimdLevel::avx512: return "avx512";
+    default:                return "scalar";
+    }
+}
+
+/**
+ *  Най-високото ниво, което процесорът поддържа. Проверява се веднъж.
+ */
+inline SimdLevel detected_simd_level()
+{
+    static const SimdLevel level = []()
+    {
+#if VECTOR_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512dq"))
+        {
+            return SimdLevel::avx512;
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return SimdLevel::avx2;
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return SimdLevel::sse2;
+        }
+#endif
+        return SimdLevel::scalar;
+    }();
+    return level;
+}
+
+/**
+ *  Нивото, с което се изпълняват ядрата: поддържаното, но не над границата от
+ *  set_simd_level_limit. Пресмята се веднъж при зареждане на програмата, затова
+ *  диспечерът на всяко ядро чете обикновена променлива вместо да проверява
+ *  процесора и атомарна граница при всяко извикване. Докато не е инициализирана
+ *  (от други статични инициализатори), стойността ѝ е SimdLevel::scalar.
+ */
+inline SimdLevel active_simd_level = detected_simd_level();
+
+/**
+ *  Ограничава нивото, което ядрата могат да използват. Служи за сравняване на
+ *  векторизираните ядра със скаларните в проверките и бенчмарковете; не е
+ *  синхронизирано с ядрата, затова се вика, преди те да се ползват от други нишки.
+ */
+inline void set_simd_level_limit(SimdLevel level)
+{
+    SimdLevel detected = detected_simd_level();
+    active_simd_level = level < detected ? level : detected;
+}
+
+inline SimdLevel simd_level()
+{
+    return active_simd_level;
+}
+
+/**
+ *  Типовете, за които има векторизирани ядра: аритметични без bool, с размер
+ *  1, 2, 4 или 8 байта. За останалите (напр. long double) се ползват скаларните ядра.
+ */
+template<typename T>
+struct simd_supported
+    : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                                   (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)>
+{};
+
+/**
+ *  Целочислен тип със същия размер като T; резултатът от векторно сравнение.
+ */
+template<typename T, size_t = sizeof(T)> struct simd_mask_of;
+template<typename T> struct simd_mask_of<T, 1> { using type = std::int8_t; };
+template<typename T> struct simd_mask_of<T, 2> { using type = std::int16_t; };
+template<typename T> struct simd_mask_of<T, 4> { using type = std::int32_t; };
+template<typename T> struct simd_mask_of<T, 8> { using type = std::int64_t; };
+
+/**
+ *  Тип на лентите при векторна аритметика: за целите числа - беззнаковият им вариант,
+ *  защото препълването на знакови ленти е недефинирано, а на беззнаковите - по модул.
+ */
+template<typename T, bool = std::is_integral<T>::value> struct simd_arith_of { using type = T; };
+template<typename T> struct simd_arith_of<T, true> { using type = typename std::make_unsigned<T>::type; };
+
+/**
+ *  Поелементни операции за simd_transform.
+ */
+enum class SimdOp
+{
+    add,
+    subtract,
+    multiply
+};
+
+/**
+ *  Прилага операцията Op; работи както с вектори, така и със скалари.
+ */
+template<SimdOp Op, typename V>
+inline V simd_apply(V a, V b)
+{
+    if constexpr (Op == SimdOp::add)
+    {
+        return a + b;
+    }
+    else if constexpr (Op == SimdOp::subtract)
+    {
+        return a - b;
+    }
+    else
+    {
+        return a * b;
+    }
+}
+
+/**
+ *  Скаларните ядра: резервен вариант и еталон, с който се сравняват векторизираните.
+ */
+namespace vector_simd_scalar
+{
+
+template<typename T>
+void fill(T* p, size_t n, T value)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        p[i] = value;
+    }
+}
+
+template<typename T>
+T sum(const T* p, size_t n)
+{
+    T result = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        result += p[i];
+    }
+    return result;
+}
+
+template<typename T>
+T dot(const T* a, const T* b, size_t n)
+{
+    T result = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+template<typename T>
+T min_value(const T* p, size_t n)
+{
+    T result = p[0];
+    for (size_t i = 1; i < n; ++i)
+    {
+        result = p[i] < result ? p[i] : result;
+    }
+    return result;
+}
+
+template<typename T>
+T max_value(const T* p, size_t n)
+{
+    T result = p[0];
+    for (size_t i = 1; i < n; ++i)
+    {
+        result = p[i] > result ? p[i] : result;
+    }
+    return result;
+}
+
+template<SimdOp Op, typename T>
+void transform(const T* a, const T* b, T* out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        out[i] = simd_apply<Op>(a[i], b[i]);
+    }
+}
+
+template<typename T>
+size_t count(const T* p, size_t n, T value)
+{
+    size_t result = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        result += p[i] == value;
+    }
+    return result;
+}
+
+template<typename T>
+size_t find(const T* p, size_t n, T value)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (p[i] == value)
+        {
+            return i;
+        }
+    }
+    return n;
+}
+
+template<typename T>
+void prefix_sum(T* p, size_t n)
+{
+    T running = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        running += p[i];
+        p[i] = running;
+    }
+}
+
+} // namespace vector_simd_scalar
+
+#if VECTOR_SIMD_X86
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#define VECTOR_SIMD_NAMESPACE vector_simd_sse2
+#define VECTOR_SIMD_WIDTH 16
+#include "VectorSimdKernels.h"
+#undef VECTOR_SIMD_NAMESPACE
+#undef VECTOR_SIMD_WIDTH
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define VECTOR_SIMD_NAMESPACE vector_simd_avx2
+#define VECTOR_SIMD_WIDTH 32
+#include "VectorSimdKernels.h"
+#undef VECTOR_SIMD_NAMESPACE
+#undef VECTOR_SIMD_WIDTH
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw,avx512dq")
+#define VECTOR_SIMD_NAMESPACE vector_simd_avx512
+#define VECTOR_SIMD_WIDTH 64
+#include "VectorSimdKernels.h"
+#undef VECTOR_SIMD_NAMESPACE
+#undef VECTOR_SIMD_WIDTH
+#pragma GCC pop_options
+
+#define VECTOR_SIMD_DISPATCH(T, call)                                   \
+    if constexpr (simd_supported<T>::value)                             \
+    {                                                                   \
+        switch (simd_level())                                           \
+        {                                                               \
+        case SimdLevel::avx512: return vector_simd_avx512::call;        \
+        case SimdLevel::avx2:   return vector_simd_avx2::call;          \
+        case SimdLevel::sse2:   return vector_simd_sse2::call;          \
+        default:                break;                                  \
+        }                                                               \
+    }                                                                   \
+    return vector_simd_scalar::call
+
+#else
+
+#define VECTOR_SIMD_DISPATCH(T, call) return vector_simd_scalar::call
+
+#endif // VECTOR_SIMD_X86
+
+/**
+ *  Присвоява value на n елемента, започвайки от p.
+ */
+template<typename T>
+void simd_fill(T* p, size_t n, T value)                                 { VECTOR_SIMD_DISPATCH(T, fill(p, n, value)); }
+
+/**
+ *  Сума на n елемента. При числа с плаваща запетая редът на събиране се различава
+ *  от скаларния, затова резултатът може да се различава в последните битове.
+ */
+template<typename T>
+T simd_sum(const T* p, size_t n)                                        { VECTOR_SIMD_DISPATCH(T, sum(p, n)); }
+
+/**
+ *  Скаларно произведение на a[0, n) и b[0, n).
+ */
+template<typename T>
+T simd_dot(const T* a, const T* b, size_t n)                            { VECTOR_SIMD_DISPATCH(T, dot(a, b, n)); }
+
+/**
+ *  Минимален и максимален елемент; n трябва да е поне 1.
+ */
+template<typename T>
+T simd_min(const T* p, size_t n)                                        { VECTOR_SIMD_DISPATCH(T, min_value(p, n)); }
+
+template<typename T>
+T simd_max(const T* p, size_t n)                                        { VECTOR_SIMD_DISPATCH(T, max_value(p, n)); }
+
+/**
+ *  out[i] = a[i] Op b[i] за i в [0, n); out може да съвпада с a или b.
+ */
+template<SimdOp Op, typename T>
+void simd_transform(const T* a, const T* b, T* out, size_t n)           { VECTOR_SIMD_DISPATCH(T, template transform<Op>(a, b, out, n)); }
+
+/**
+ *  Брой елементи, равни на value.
+ */
+template<typename T>
+size_t simd_count(const T* p, size_t n, T value)                        { VECTOR_SIMD_DISPATCH(T, count(p, n, value)); }
+
+/**
+ *  Индекс на първия елемент, равен на value, или n, ако няма такъв.
+ */
+template<typename T>
+size_t simd_find(const T* p, size_t n, T value)                         { VECTOR_SIMD_DISPATCH(T, find(p, n, value)); }
+
+/**
+ *  Включваща префиксна сума на място: p[i] = p[0] + ... + p[i].
+ */
+template<typename T>
+void simd_prefix_sum(T* p, size_t n)                                    { VECTOR_SIMD_DISPATCH(T, prefix_sum(p, n)); }
+
+#undef VECTOR_SIMD_DISPATCH
+
+#endif // VECTORSIMD_H
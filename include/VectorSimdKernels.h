@@ -0,0 +1,305 @@
+// Без include guard: файлът се включва от VectorSimd.h веднъж за всеки набор от инструкции.
+// Преди включването трябва да са дефинирани VECTOR_SIMD_NAMESPACE (име на пространството)
+// и VECTOR_SIMD_WIDTH (ширина на векторния регистър в байтове), а #pragma GCC target
+// определя за кой набор от инструкции се компилират функциите.
+
+/**
+ *  Числени ядра върху непрекъснат масив, написани с векторните разширения на GCC.
+ *  Редукциите обработват по два регистъра на итерация, а остатъкът се довършва
+ *  скаларно. Събирането и умножението на цели числа се прави в беззнакови ленти (Acc).
+ *  Функциите са шаблони, валидни за типовете, за които simd_supported е true.
+ */
+namespace VECTOR_SIMD_NAMESPACE
+{
+
+template<typename T>
+struct Lanes
+{
+    static constexpr size_t width = VECTOR_SIMD_WIDTH;
+    static constexpr size_t count = width / sizeof(T);
+
+    typedef T Vec __attribute__((vector_size(VECTOR_SIMD_WIDTH)));
+    typedef typename simd_mask_of<T>::type Mask __attribute__((vector_size(VECTOR_SIMD_WIDTH)));
+    typedef typename simd_arith_of<T>::type Acc __attribute__((vector_size(VECTOR_SIMD_WIDTH)));
+
+    static Vec load(const T* p)         { Vec v; __builtin_memcpy(&v, p, sizeof(Vec)); return v; }
+    static void store(T* p, Vec v)      { __builtin_memcpy(p, &v, sizeof(Vec)); }
+    static Acc load_acc(const T* p)     { Acc v; __builtin_memcpy(&v, p, sizeof(Acc)); return v; }
+    static void store_acc(T* p, Acc v)  { __builtin_memcpy(p, &v, sizeof(Acc)); }
+
+    static Vec broadcast(T value)
+    {
+        Vec v;
+        for (size_t l = 0; l < count; ++l)
+        {
+            v[l] = value;
+        }
+        return v;
+    }
+};
+
+template<typename T>
+void fill(T* p, size_t n, T value)
+{
+    using L = Lanes<T>;
+    const typename L::Vec v = L::broadcast(value);
+
+    size_t i = 0;
+    for (; i + L::count <= n; i += L::count)
+    {
+        L::store(p + i, v);
+    }
+    for (; i < n; ++i)
+    {
+        p[i] = value;
+    }
+}
+
+template<typename T>
+T sum(const T* p, size_t n)
+{
+    using L = Lanes<T>;
+    typename L::Acc acc0 = {}, acc1 = {};
+
+    size_t i = 0;
+    for (; i + 2 * L::count <= n; i += 2 * L::count)
+    {
+        acc0 += L::load_acc(p + i);
+        acc1 += L::load_acc(p + i + L::count);
+    }
+    acc0 += acc1;
+
+    T result = 0;
+    for (size_t l = 0; l < L::count; ++l)
+    {
+        result += acc0[l];
+    }
+    for (; i < n; ++i)
+    {
+        result += p[i];
+    }
+    return result;
+}
+
+template<typename T>
+T dot(const T* a, const T* b, size_t n)
+{
+    using L = Lanes<T>;
+    typename L::Acc acc0 = {}, acc1 = {};
+
+    size_t i = 0;
+    for (; i + 2 * L::count <= n; i += 2 * L::count)
+    {
+        acc0 += L::load_acc(a + i) * L::load_acc(b + i);
+        acc1 += L::load_acc(a + i + L::count) * L::load_acc(b + i + L::count);
+    }
+    acc0 += acc1;
+
+    T result = 0;
+    for (size_t l = 0; l < L::count; ++l)
+    {
+        result += acc0[l];
+    }
+    for (; i < n; ++i)
+    {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+/**
+ *  Минимум (Less == true) или максимум (Less == false) на непразен масив.
+ *  SSE2 няма сравнение на 64-битови цели числа, затова за тях се ползва скаларното ядро.
+ */
+template<bool Less, typename T>
+T extremum(const T* p, size_t n)
+{
+    using L = Lanes<T>;
+    if constexpr (std::is_integral<T>::value && sizeof(T) == 8 && L::width == 16)
+    {
+        return Less ? vector_simd_scalar::min_value(p, n) : vector_simd_scalar::max_value(p, n);
+    }
+    T result = p[0];
+
+    size_t i = 0;
+    if (n >= L::count)
+    {
+        typename L::Vec best = L::load(p);
+        for (i = L::count; i + L::count <= n; i += L::count)
+        {
+            typename L::Vec v = L::load(p + i);
+            best = Less ? (v < best ? v : best) : (v > best ? v : best);
+        }
+        for (size_t l = 0; l < L::count; ++l)
+        {
+            result = Less ? (best[l] < result ? best[l] : result) : (best[l] > result ? best[l] : result);
+        }
+    }
+    for (; i < n; ++i)
+    {
+        result = Less ? (p[i] < result ? p[i] : result) : (p[i] > result ? p[i] : result);
+    }
+    return result;
+}
+
+template<typename T>
+T min_value(const T* p, size_t n)       { return extremum<true>(p, n); }
+
+template<typename T>
+T max_value(const T* p, size_t n)       { return extremum<false>(p, n); }
+
+/**
+ *  Поелементна операция out[i] = a[i] Op b[i]. Векторната стъпка е написана тук,
+ *  а не чрез simd_apply, за да се компилира с набора от инструкции на ядрото.
+ */
+template<SimdOp Op, typename T>
+void transform(const T* a, const T* b, T* out, size_t n)
+{
+    using L = Lanes<T>;
+
+    size_t i = 0;
+    for (; i + L::count <= n; i += L::count)
+    {
+        typename L::Acc x = L::load_acc(a + i), y = L::load_acc(b + i);
+        if constexpr (Op == SimdOp::add)
+        {
+            L::store_acc(out + i, x + y);
+        }
+        else if constexpr (Op == SimdOp::subtract)
+        {
+            L::store_acc(out + i, x - y);
+        }
+        else
+        {
+            L::store_acc(out + i, x * y);
+        }
+    }
+    for (; i < n; ++i)
+    {
+        out[i] = simd_apply<Op>(a[i], b[i]);
+    }
+}
+
+template<typename T>
+size_t count(const T* p, size_t n, T value)
+{
+    using L = Lanes<T>;
+    const typename L::Vec needle = L::broadcast(value);
+    // броячите в лентите са с размера на T, затова се изпразват, преди да препълнят
+    constexpr size_t max_blocks = std::numeric_limits<typename simd_mask_of<T>::type>::max();
+
+    size_t result = 0;
+    size_t i = 0;
+    while (i + L::count <= n)
+    {
+        typename L::Mask matches = {};      // сравнението дава -1 за всяко съвпадение
+        for (size_t blocks = 0; blocks < max_blocks && i + L::count <= n; ++blocks, i += L::count)
+        {
+            matches -= (L::load(p + i) == needle);
+        }
+        for (size_t l = 0; l < L::count; ++l)
+        {
+            result += static_cast<size_t>(matches[l]);
+        }
+    }
+    for (; i < n; ++i)
+    {
+        result += p[i] == value;
+    }
+    return result;
+}
+
+/**
+ *  Индекс на първия елемент, равен на value, или n, ако няма такъв.
+ */
+template<typename T>
+size_t find(const T* p, size_t n, T value)
+{
+    using L = Lanes<T>;
+    const typename L::Vec needle = L::broadcast(value);
+
+    size_t i = 0;
+    for (; i + L::count <= n; i += L::count)
+    {
+        typename L::Mask eq = (L::load(p + i) == needle);
+
+        bool any = false;
+        for (size_t l = 0; l < L::count; ++l)
+        {
+            any |= eq[l] != 0;
+        }
+        if (any)
+        {
+            break;                          // съвпадението е в този блок, довършва се скаларно
+        }
+    }
+    for (; i < n; ++i)
+    {
+        if (p[i] == value)
+        {
+            return i;
+        }
+    }
+    return n;
+}
+
+/**
+ *  Включваща префиксна сума на място. Всеки регистър се сканира с log2(count)
+ *  изместващи събирания, след което към него се добавя сумата на предходните блокове.
+ *  При 8-байтови елементи в по-тесни от 64 байта регистри веригата от разбърквания
+ *  е по-бавна от скаларния цикъл, затова тогава се ползва скаларното ядро.
+ */
+template<typename T>
+void prefix_sum(T* p, size_t n)
+{
+    using L = Lanes<T>;
+    if constexpr (L::count < 4 || (sizeof(T) == 8 && L::count < 8))
+    {
+        vector_simd_scalar::prefix_sum(p, n);
+        return;
+    }
+    constexpr size_t steps = L::count == 2 ? 1 : L::count == 4 ? 2 : L::count == 8 ? 3 :
+                             L::count == 16 ? 4 : L::count == 32 ? 5 : 6;
+
+    // маска за всяка стъпка: лента l взима лента l - shift, а първите shift ленти - нула
+    typename L::Mask indices[steps];
+    for (size_t step = 0, shift = 1; step < steps; ++step, shift *= 2)
+    {
+        for (size_t l = 0; l < L::count; ++l)
+        {
+            indices[step][l] = l >= shift ? l - shift : L::count;
+        }
+    }
+
+    typename L::Mask last;                  // разпръсква последната лента във всички
+    for (size_t l = 0; l < L::count; ++l)
+    {
+        last[l] = L::count - 1;
+    }
+
+    // сумата на предходните блокове се пази във вектор, за да не минава през скаларен регистър
+    const typename L::Acc zero = {};
+    typename L::Acc carry = {};
+
+    size_t i = 0;
+    for (; i + L::count <= n; i += L::count)
+    {
+        typename L::Acc v = L::load_acc(p + i);
+        for (size_t step = 0; step < steps; ++step)
+        {
+            v += __builtin_shuffle(v, zero, indices[step]);
+        }
+        v += carry;
+        L::store_acc(p + i, v);
+        carry = __builtin_shuffle(v, last);
+    }
+
+    T running = static_cast<T>(carry[0]);
+    for (; i < n; ++i)
+    {
+        running += p[i];
+        p[i] = running;
+    }
+}
+
+} // namespace VECTOR_SIMD_NAMESPACE
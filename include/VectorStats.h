@@ -0,0 +1,172 @@
+#ifndef VECTORSTATS_H
+#define VECTORSTATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <typeinfo>
+
+/**
+ *  Инструментиране на Vector. Включва се при компилация с -DVECTOR_ENABLE_STATS
+ *  (CMake опция VECTOR_ENABLE_STATS); без него VECTOR_STATS_HOOK не генерира код,
+ *  а Vector и VectorBase нямат допълнителни членове.
+ *
+ *  - всеки Vector брои своите събития в stats();
+ *  - vector_type_stats<T>() събира статистиката на всички вектори с елементи T:
+ *    заделянията и освобождаванията се броят веднага от VectorBase, а останалото
+ *    се добавя при унищожаването на всеки вектор;
+ *  - ако е зададен vector_stats_callback(), той се извиква със статистиката на
+ *    всеки унищожен вектор, например за да се подаде към система за метрики.
+ */
+#ifdef VECTOR_ENABLE_STATS
+#define VECTOR_STATS_HOOK(statement) statement
+#else
+#define VECTOR_STATS_HOOK(statement)
+#endif
+
+/**
+ *  Броячи на един вектор.
+ */
+struct VectorStats
+{
+    size_t allocations = 0;         // заделени буфери
+    size_t deallocations = 0;       // освободени буфери
+    size_t reallocations = 0;       // нараствания или смалявания с преместване на елементите
+    size_t bytes_allocated = 0;     // общо заделени байтове
+    size_t bytes_moved = 0;         // байтове на елементите, преместени при преразпределяне
+    size_t constructions = 0;       // конструирани елементи
+    size_t destructions = 0;        // унищожени елементи
+    size_t peak_capacity = 0;       // най-големият достигнат капацитет (в елементи)
+    size_t peak_size = 0;           // най-големият наблюдаван брой елементи
+
+    void on_allocate(size_t capacity, size_t element_size)
+    {
+        ++allocations;
+        bytes_allocated += capacity * element_size;
+        if (capacity > peak_capacity)
+        {
+            peak_capacity = capacity;
+        }
+    }
+
+    void on_reallocate(size_t capacity, size_t moved, size_t element_size)
+    {
+        ++reallocations;
+        ++deallocations;
+        bytes_moved += moved * element_size;
+        on_allocate(capacity, element_size);
+    }
+
+    void on_size(size_t size)
+    {
+        if (size > peak_size)
+        {
+            peak_size = size;
+        }
+    }
+};
+
+/**
+ *  Сборна статистика за всички вектори с един и същи тип на елементите.
+ *  Броячите са атомарни, защото вектори от един тип живеят в различни нишки.
+ */
+struct VectorTypeStats
+{
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> deallocations{0};
+    std::atomic<size_t> reallocations{0};
+    std::atomic<size_t> bytes_allocated{0};
+    std::atomic<size_t> bytes_moved{0};
+    std::atomic<size_t> constructions{0};
+    std::atomic<size_t> destructions{0};
+    std::atomic<size_t> peak_capacity{0};
+    std::atomic<size_t> peak_size{0};
+    std::atomic<size_t> instances{0};       // брой унищожени вектори, чиято статистика е добавена
+
+    void on_allocate(size_t bytes)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void on_deallocate()
+    {
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void merge(const VectorStats& stats);
+    VectorStats snapshot() const;
+
+private:
+    static void update_max(std::atomic<size_t>& target, size_t value)
+    {
+        size_t current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+};
+
+/**
+ *  Добавя статистиката на унищожен вектор. Заделянията и освобождаванията не се
+ *  добавят, защото VectorBase ги брои директно.
+ */
+inline void VectorTypeStats::merge(const VectorStats& stats)
+{
+    reallocations.fetch_add(stats.reallocations, std::memory_order_relaxed);
+    bytes_moved.fetch_add(stats.bytes_moved, std::memory_order_relaxed);
+    constructions.fetch_add(stats.constructions, std::memory_order_relaxed);
+    destructions.fetch_add(stats.destructions, std::memory_order_relaxed);
+    update_max(peak_capacity, stats.peak_capacity);
+    update_max(peak_size, stats.peak_size);
+    instances.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline VectorStats VectorTypeStats::snapshot() const
+{
+    VectorStats stats;
+    stats.allocations = allocations.load(std::memory_order_relaxed);
+    stats.deallocations = deallocations.load(std::memory_order_relaxed);
+    stats.reallocations = reallocations.load(std::memory_order_relaxed);
+    stats.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+    stats.bytes_moved = bytes_moved.load(std::memory_order_relaxed);
+    stats.constructions = constructions.load(std::memory_order_relaxed);
+    stats.destructions = destructions.load(std::memory_order_relaxed);
+    stats.peak_capacity = peak_capacity.load(std::memory_order_relaxed);
+    stats.peak_size = peak_size.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ *  Сборната статистика за вектори с елементи от тип T.
+ */
+template<typename T>
+VectorTypeStats& vector_type_stats()
+{
+    static VectorTypeStats stats;
+    return stats;
+}
+
+/**
+ *  Функция, която се извиква със статистиката на всеки унищожен вектор.
+ *  type_name е typeid(T).name() на елементите.
+ */
+using VectorStatsCallback = void (*)(const char* type_name, const VectorStats& stats);
+
+inline std::atomic<VectorStatsCallback>& vector_stats_callback()
+{
+    static std::atomic<VectorStatsCallback> callback{nullptr};
+    return callback;
+}
+
+/**
+ *  Добавя статистиката на унищожен вектор към сборната за типа и я подава на callback-а.
+ */
+template<typename T>
+void report_vector_stats(const VectorStats& stats)
+{
+    vector_type_stats<T>().merge(stats);
+    if (VectorStatsCallback callback = vector_stats_callback().load(std::memory_order_relaxed))
+    {
+        callback(typeid(T).name(), stats);
+    }
+}
+
+#endif // VECTORSTATS_H
@@ -0,0 +1,49 @@
+#ifndef VECTORTRAITS_H
+#define VECTORTRAITS_H
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+/**
+ *  Признак, който указва дали обект от тип T може да бъде преместен на нов адрес
+ *  чрез побитово копиране (memcpy), като старото копие просто се "забрави", без
+ *  да се извикват преместващият конструктор и деструкторът.
+ *  По подразбиране това важи за всички тривиално копируеми типове. Потребителски
+ *  типове, които не държат указатели към самите себе си, могат да се включат явно:
+ *
+ *      template<> struct is_trivially_relocatable<MyType> : std::true_type {};
+ */
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+/**
+ *  Признак, който указва дали алокаторът A само заделя памет, без да добавя нещо
+ *  към конструирането и унищожаването на елементите (construct/destroy по подразбиране).
+ *  Тогава контейнерите копират и запълват новите елементи директно, включително
+ *  с векторизираните ядра от VectorSimd.h. Алокатори без собствени construct/destroy
+ *  могат да се включат явно, както AlignedAllocator:
+ *
+ *      template<typename T> struct is_plain_allocator<MyAllocator<T> > : std::true_type {};
+ */
+template<typename A>
+struct is_plain_allocator : std::false_type {};
+
+template<typename T>
+struct is_plain_allocator<std::allocator<T> > : std::true_type {};
+
+/**
+ *  Признак, който указва дали паметта на вектор с елементи T и алокатор A
+ *  може да се уголемява на място чрез std::realloc. Това е възможно само за
+ *  стандартния алокатор (няма потребителско състояние, което да пазим),
+ *  тривиално преместваеми елементи и подравняване, което malloc гарантира.
+ *  При големи буфери glibc изпълнява realloc чрез mremap, т.е. без копиране.
+ */
+template<typename T, typename A>
+struct is_reallocatable
+    : std::integral_constant<bool,
+        std::is_same<A, std::allocator<T> >::value &&
+        is_trivially_relocatable<T>::value &&
+        alignof(T) <= alignof(std::max_align_t)> {};
+
+#endif // VECTORTRAITS_H